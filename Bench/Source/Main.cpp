@@ -0,0 +1,499 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+    Headless renderer and benchmark for TeArAudioProcessor.
+
+    Runs the processor outside a DAW, as fast as possible, with a fake play
+    head and a scripted MIDI input, and reports the time spent per block.
+    The rendered MIDI can be written to a file, to compare renders on CI.
+    Once warmed up, the processor must not allocate: the program fails if
+    anything is allocated during a processBlock (see AllocationCounter).
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/PatternCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#if JUCE_WINDOWS
+ #include <malloc.h>
+#endif
+
+//==============================================================================
+/** Counts the allocations, from any thread, while it is enabled: the calls
+    to every form of the global operator new and, on Linux, to malloc and its
+    family, through which juce::Array, MidiBuffer and HeapBlock grow. */
+struct AllocationCounter
+{
+    static inline std::atomic<bool> enabled { false };
+    static inline std::atomic<juce::int64> count { 0 };
+};
+
+static void countAllocation() noexcept
+{
+    if (AllocationCounter::enabled.load (std::memory_order_relaxed))
+        AllocationCounter::count.fetch_add (1, std::memory_order_relaxed);
+}
+
+#if JUCE_LINUX && defined (__GLIBC__)
+ // glibc lets a program replace malloc and its family, and exports the
+ // functions they forward to. operator new goes through them too.
+ #define TEAR_BENCH_COUNTS_MALLOC 1
+
+ extern "C"
+ {
+     void* __libc_malloc (std::size_t);
+     void* __libc_calloc (std::size_t, std::size_t);
+     void* __libc_realloc (void*, std::size_t);
+     void* __libc_memalign (std::size_t, std::size_t);
+     void __libc_free (void*);
+
+     void* malloc (std::size_t size) noexcept                        { countAllocation(); return __libc_malloc (size); }
+     void* calloc (std::size_t count, std::size_t size) noexcept     { countAllocation(); return __libc_calloc (count, size); }
+     void* realloc (void* memory, std::size_t size) noexcept         { countAllocation(); return __libc_realloc (memory, size); }
+     void* memalign (std::size_t alignment, std::size_t size) noexcept       { countAllocation(); return __libc_memalign (alignment, size); }
+     void* aligned_alloc (std::size_t alignment, std::size_t size) noexcept  { countAllocation(); return __libc_memalign (alignment, size); }
+     void free (void* memory) noexcept                               { __libc_free (memory); }
+
+     int posix_memalign (void** result, std::size_t alignment, std::size_t size) noexcept
+     {
+         if (alignment % sizeof (void*) != 0 || ! juce::isPowerOfTwo (alignment))
+             return EINVAL;
+
+         countAllocation();
+         *result = __libc_memalign (alignment, size);
+         return *result != nullptr ? 0 : ENOMEM;
+     }
+ }
+#else
+ #define TEAR_BENCH_COUNTS_MALLOC 0
+#endif
+
+static void* allocate (std::size_t size)
+{
+   #if ! TEAR_BENCH_COUNTS_MALLOC
+    countAllocation();
+   #endif
+
+    if (auto* memory = std::malloc (size > 0 ? size : 1))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+static void* allocateAligned (std::size_t size, std::align_val_t alignment)
+{
+   #if ! TEAR_BENCH_COUNTS_MALLOC
+    countAllocation();
+   #endif
+
+    const auto numBytes = size > 0 ? size : 1;
+   #if JUCE_WINDOWS
+    if (auto* memory = _aligned_malloc (numBytes, (std::size_t) alignment))
+        return memory;
+   #else
+    void* memory = nullptr;
+    if (posix_memalign (&memory, juce::jmax ((std::size_t) alignment, sizeof (void*)), numBytes) == 0)
+        return memory;
+   #endif
+
+    throw std::bad_alloc();
+}
+
+static void freeAligned (void* memory) noexcept
+{
+   #if JUCE_WINDOWS
+    _aligned_free (memory);
+   #else
+    std::free (memory);
+   #endif
+}
+
+void* operator new (std::size_t size)                                               { return allocate (size); }
+void* operator new[] (std::size_t size)                                             { return allocate (size); }
+void* operator new (std::size_t size, std::align_val_t alignment)                   { return allocateAligned (size, alignment); }
+void* operator new[] (std::size_t size, std::align_val_t alignment)                 { return allocateAligned (size, alignment); }
+
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept               { try { return allocate (size); } catch (...) { return nullptr; } }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept             { try { return allocate (size); } catch (...) { return nullptr; } }
+void* operator new (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept   { try { return allocateAligned (size, alignment); } catch (...) { return nullptr; } }
+void* operator new[] (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { try { return allocateAligned (size, alignment); } catch (...) { return nullptr; } }
+
+void operator delete (void* memory) noexcept                                        { std::free (memory); }
+void operator delete[] (void* memory) noexcept                                      { std::free (memory); }
+void operator delete (void* memory, std::size_t) noexcept                           { std::free (memory); }
+void operator delete[] (void* memory, std::size_t) noexcept                         { std::free (memory); }
+void operator delete (void* memory, const std::nothrow_t&) noexcept                 { std::free (memory); }
+void operator delete[] (void* memory, const std::nothrow_t&) noexcept               { std::free (memory); }
+
+void operator delete (void* memory, std::align_val_t) noexcept                      { freeAligned (memory); }
+void operator delete[] (void* memory, std::align_val_t) noexcept                    { freeAligned (memory); }
+void operator delete (void* memory, std::size_t, std::align_val_t) noexcept         { freeAligned (memory); }
+void operator delete[] (void* memory, std::size_t, std::align_val_t) noexcept       { freeAligned (memory); }
+void operator delete (void* memory, std::align_val_t, const std::nothrow_t&) noexcept   { freeAligned (memory); }
+void operator delete[] (void* memory, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned (memory); }
+
+//==============================================================================
+/** A play head that follows the offline render, at a fixed tempo. */
+class FakePlayHead : public juce::AudioPlayHead
+{
+public:
+    juce::Optional<PositionInfo> getPosition() const override
+    {
+        PositionInfo info;
+        info.setBpm (bpm);
+        info.setTimeSignature (TimeSignature {});
+        info.setTimeInSamples (timeInSamples);
+        info.setTimeInSeconds ((double) timeInSamples / sampleRate);
+        info.setIsPlaying (isPlaying);
+
+        // Like a host, the position restarts from the start of the loop at the
+        // first block that starts past its end.
+        const auto ppqPosition = (double) timeInSamples / sampleRate * bpm / 60.0;
+        info.setPpqPosition (loopLength > 0.0 ? std::fmod (ppqPosition, loopLength) : ppqPosition);
+        info.setIsLooping (loopLength > 0.0);
+        if (loopLength > 0.0)
+            info.setLoopPoints (LoopPoints { 0.0, loopLength });
+
+        return info;
+    }
+
+    double bpm = 120.0;
+    double loopLength = 0.0;    // In quarter notes, 0 for no loop
+    double sampleRate = 48000.0;
+    juce::int64 timeInSamples = 0;
+    bool isPlaying = true;
+};
+
+//==============================================================================
+/** A MIDI input event, in samples from the start of the script. */
+struct ScriptedEvent
+{
+    juce::int64 samplePosition;
+    juce::MidiMessage message;
+};
+
+static std::vector<ScriptedEvent> loadScript (const juce::File& file, double sampleRate, juce::int64& scriptLength)
+{
+    std::vector<ScriptedEvent> script;
+    scriptLength = 0;
+
+    if (file == juce::File())
+    {
+        // Without a script, hold a C major chord for the whole render.
+        for (auto note : { 60, 64, 67 })
+            script.push_back ({ 0, juce::MidiMessage::noteOn (1, note, (juce::uint8) 100) });
+        return script;
+    }
+
+    juce::FileInputStream input (file);
+    juce::MidiFile midiFile;
+    if (input.failedToOpen() || ! midiFile.readFrom (input))
+    {
+        std::cerr << "Cannot read MIDI file " << file.getFullPathName() << std::endl;
+        return script;
+    }
+
+    midiFile.convertTimestampTicksToSeconds();
+
+    juce::MidiMessageSequence sequence;
+    for (int track = 0; track < midiFile.getNumTracks(); ++track)
+        sequence.addSequence (*midiFile.getTrack (track), 0.0);
+    sequence.updateMatchedPairs();
+
+    for (auto* event : sequence)
+        if (event->message.isNoteOnOrOff())
+            script.push_back ({ (juce::int64) (event->message.getTimeStamp() * sampleRate), event->message });
+
+    // The script is looped over the render, so its length is the end of the file.
+    scriptLength = juce::jmax ((juce::int64) 1, (juce::int64) std::ceil (sequence.getEndTime() * sampleRate));
+    if (! script.empty())
+        scriptLength = juce::jmax (scriptLength, script.back().samplePosition + 1);
+
+    return script;
+}
+
+static bool writeMidiFile (const juce::File& file, const juce::MidiMessageSequence& sequence, double bpm)
+{
+    juce::MidiFile midiFile;
+    midiFile.setTicksPerQuarterNote (960);
+
+    juce::MidiMessageSequence track;
+    track.addEvent (juce::MidiMessage::tempoMetaEvent (juce::roundToInt (60000000.0 / bpm)), 0.0);
+    track.addSequence (sequence, 0.0);
+    track.updateMatchedPairs();
+    midiFile.addTrack (track);
+
+    file.deleteFile();
+    juce::FileOutputStream output (file);
+    return ! output.failedToOpen() && midiFile.writeTo (output);
+}
+
+//==============================================================================
+/** The state as the plugin saved it before the binary format: the XML of the
+    parameters, with the patterns and lane switches added as attributes. */
+static void writeXmlState (TeArAudioProcessor& processor, juce::MemoryBlock& destData)
+{
+    std::unique_ptr<juce::XmlElement> xml (processor.getAPVTS().copyState().createXml());
+
+    for (int i = 0; i < processor.getNumArpeggiators(); ++i)
+        xml->setAttribute ("arpeggiatorPattern" + juce::String (i), processor.getArpeggiatorPattern (i));
+    for (int i = 0; i < processor.getNumArpeggiators(); ++i)
+        xml->setAttribute ("arpOn" + juce::String (i), processor.isArpeggiatorOn (i));
+
+    juce::AudioProcessor::copyXmlToBinary (*xml, destData);
+}
+
+/** Times saving and loading the processor's state, in the binary format and
+    in the XML format of earlier versions, which the plugin still reads. */
+static void runStateBenchmark (TeArAudioProcessor& processor, int iterations)
+{
+    auto timeInNs = [iterations] (auto&& function)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+            function();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return (double) std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count() / iterations;
+    };
+
+    juce::MemoryBlock binaryState, xmlState;
+    processor.getStateInformation (binaryState);
+    writeXmlState (processor, xmlState);
+
+    const auto binarySave = timeInNs ([&] { processor.getStateInformation (binaryState); });
+    const auto binaryLoad = timeInNs ([&] { processor.setStateInformation (binaryState.getData(), (int) binaryState.getSize()); });
+    const auto xmlSave = timeInNs ([&] { writeXmlState (processor, xmlState); });
+    const auto xmlLoad = timeInNs ([&] { processor.setStateInformation (xmlState.getData(), (int) xmlState.getSize()); });
+
+    std::cout << "TeAr state benchmark: " << processor.getNumArpeggiators() << " lanes, " << iterations << " iterations\n"
+              << "binary: " << binaryState.getSize() << " bytes, save " << binarySave << " ns, load " << binaryLoad << " ns\n"
+              << "xml:    " << xmlState.getSize() << " bytes, save " << xmlSave << " ns, load " << xmlLoad << " ns" << std::endl;
+}
+
+static void printUsage()
+{
+    std::cout << "Usage: TeArBench [options]\n"
+                 "  --state <file>      state saved by the plugin (getStateInformation format)\n"
+                 "  --midi <file.mid>   MIDI input, looped over the render (default: a held C major chord)\n"
+                 "  --bpm <n>           tempo of the play head (default: 120)\n"
+                 "  --rate <n>          sample rate (default: 48000)\n"
+                 "  --block <n>         block size in samples (default: 512)\n"
+                 "  --minutes <n>       length of the render (default: 10)\n"
+                 "  --lanes <n>         number of arpeggiator lanes, 1 to 16 (default: the plugin's)\n"
+                 "  --serial            run all the lanes on the audio thread, without worker threads\n"
+                 "  --stopped           render with the transport stopped\n"
+                 "  --loop <beats>      loop the transport over this many quarter notes\n"
+                 "  --seed <n>          seed of the random choices (default: the state's, or 0 without a state)\n"
+                 "  --out <file.mid>    write the rendered MIDI to a file\n"
+                 "  --state-bench <n>   time n saves and loads of the state, binary and XML, instead of rendering\n"
+                 "  --unit-tests        run the plugin's unit tests instead of rendering\n";
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    if (args.containsOption ("--unit-tests"))
+    {
+        juce::UnitTestRunner runner;
+        runner.runTestsInCategory ("TeAr");
+
+        for (int i = 0; i < runner.getNumResults(); ++i)
+            if (runner.getResult (i)->failures > 0)
+                return 1;
+
+        return 0;
+    }
+
+    auto getOption = [&args] (juce::StringRef option, double defaultValue)
+    {
+        return args.containsOption (option) ? args.getValueForOption (option).getDoubleValue() : defaultValue;
+    };
+
+    const double bpm = getOption ("--bpm", 120.0);
+    const double sampleRate = getOption ("--rate", 48000.0);
+    const int blockSize = juce::jmax (1, (int) getOption ("--block", 512));
+    const double minutes = getOption ("--minutes", 10.0);
+
+    const int numLanes = (int) getOption ("--lanes", TEAR_NUM_ARPS);
+
+    TeArAudioProcessor processor (numLanes);
+    processor.setUseWorkerThreads (! args.containsOption ("--serial"));
+
+    // A fixed seed, so that two renders of the same input can be compared.
+    processor.setRandomSeed (0);
+
+    if (args.containsOption ("--state"))
+    {
+        juce::MemoryBlock state;
+        const auto stateFile = args.getFileForOption ("--state");
+        if (! stateFile.loadFileAsData (state))
+        {
+            std::cerr << "Cannot read state file " << stateFile.getFullPathName() << std::endl;
+            return 1;
+        }
+        processor.setStateInformation (state.getData(), (int) state.getSize());
+    }
+
+    if (args.containsOption ("--seed"))
+        processor.setRandomSeed (args.getValueForOption ("--seed").getLargeIntValue());
+
+    if (args.containsOption ("--state-bench"))
+    {
+        runStateBenchmark (processor, juce::jmax (1, (int) getOption ("--state-bench", 1000)));
+        return 0;
+    }
+
+    juce::int64 scriptLength = 0;
+    const auto script = loadScript (args.containsOption ("--midi") ? args.getFileForOption ("--midi") : juce::File(),
+                                    sampleRate, scriptLength);
+
+    FakePlayHead playHead;
+    playHead.bpm = bpm;
+    playHead.sampleRate = sampleRate;
+    playHead.isPlaying = ! args.containsOption ("--stopped");
+    playHead.loopLength = juce::jmax (0.0, getOption ("--loop", 0.0));
+
+    processor.setPlayHead (&playHead);
+    processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+    processor.prepareToPlay (sampleRate, blockSize);
+
+    juce::AudioBuffer<float> buffer (juce::jmax (1, processor.getTotalNumOutputChannels()), blockSize);
+    juce::MidiBuffer midiMessages;
+    juce::MidiMessageSequence rendered;
+
+    // The buffer grows with the events the processor adds to it, which would
+    // count as its allocations: give it room up front.
+    midiMessages.ensureSize (65536);
+
+    // The first blocks may still set things up (the lanes' first chords and
+    // patterns, the worker threads); the allocations are counted after them.
+    constexpr size_t numWarmUpBlocks = 16;
+    const bool keepOutput = args.containsOption ("--out");
+
+    const auto numBlocks = (size_t) juce::jmax (1.0, std::ceil (minutes * 60.0 * sampleRate / blockSize));
+    std::vector<juce::int64> blockTimes;
+    blockTimes.reserve (numBlocks);
+
+    size_t scriptIndex = 0;
+    juce::int64 scriptOffset = 0;
+    juce::int64 numOutputEvents = 0;
+
+    for (size_t block = 0; block < numBlocks; ++block)
+    {
+        const auto blockStart = (juce::int64) block * blockSize;
+        const auto blockEnd = blockStart + blockSize;
+
+        // Feed the scripted input that falls in this block.
+        midiMessages.clear();
+        while (scriptIndex < script.size() && script[scriptIndex].samplePosition + scriptOffset < blockEnd)
+        {
+            const auto& event = script[scriptIndex];
+            midiMessages.addEvent (event.message, (int) (event.samplePosition + scriptOffset - blockStart));
+
+            if (++scriptIndex == script.size() && scriptLength > 0)
+            {
+                scriptIndex = 0;
+                scriptOffset += scriptLength;
+            }
+        }
+
+        playHead.timeInSamples = blockStart;
+        buffer.clear();
+
+        AllocationCounter::enabled = block >= numWarmUpBlocks;
+
+        const auto start = std::chrono::steady_clock::now();
+        processor.processBlock (buffer, midiMessages);
+        const auto end = std::chrono::steady_clock::now();
+
+        AllocationCounter::enabled = false;
+
+        blockTimes.push_back (std::chrono::duration_cast<std::chrono::nanoseconds> (end - start).count());
+        numOutputEvents += midiMessages.getNumEvents();
+
+        if (keepOutput)
+        {
+            for (const auto metadata : midiMessages)
+            {
+                auto message = metadata.getMessage();
+                const auto seconds = (double) (blockStart + metadata.samplePosition) / sampleRate;
+                message.setTimeStamp (seconds * bpm / 60.0 * 960.0);
+                rendered.addEvent (message);
+            }
+        }
+    }
+
+    processor.releaseResources();
+
+    // --- Report ---
+    juce::int64 totalTime = 0;
+    for (auto time : blockTimes)
+        totalTime += time;
+
+    auto sortedTimes = blockTimes;
+    std::sort (sortedTimes.begin(), sortedTimes.end());
+    auto percentile = [&sortedTimes] (double p)
+    {
+        return sortedTimes[juce::jmin (sortedTimes.size() - 1, (size_t) (p * (double) sortedTimes.size()))];
+    };
+
+    const auto totalSeconds = (double) totalTime * 1.0e-9;
+    const auto renderedSeconds = (double) numBlocks * blockSize / sampleRate;
+
+    std::cout << "TeAr benchmark: " << processor.getNumArpeggiators() << " lanes, " << sampleRate << " Hz, " << blockSize << " samples/block, "
+              << bpm << " bpm, " << numBlocks << " blocks (" << renderedSeconds << " s)\n"
+              << "ns/block: mean " << totalTime / (juce::int64) numBlocks
+              << ", p50 " << percentile (0.5)
+              << ", p99 " << percentile (0.99)
+              << ", max " << sortedTimes.back() << "\n"
+              << "output events: " << numOutputEvents
+              << " (" << (totalSeconds > 0.0 ? (double) numOutputEvents / totalSeconds : 0.0) << " events/s)\n"
+              << "real-time factor: " << (totalSeconds > 0.0 ? renderedSeconds / totalSeconds : 0.0) << "\n"
+              << "allocations in processBlock after " << numWarmUpBlocks << " blocks: " << AllocationCounter::count.load() << "\n";
+
+    const auto cacheStatistics = PatternCache::getInstance()->getStatistics();
+    std::cout << "pattern cache: " << cacheStatistics.hits << " hits, " << cacheStatistics.misses << " misses, "
+              << cacheStatistics.numPatterns << " patterns" << std::endl;
+
+    if (keepOutput)
+    {
+        const auto outFile = args.getFileForOption ("--out");
+        if (! writeMidiFile (outFile, rendered, bpm))
+        {
+            std::cerr << "Cannot write MIDI file " << outFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    if (AllocationCounter::count.load() > 0)
+    {
+        std::cerr << "The processor allocated memory while rendering" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+/*
+  ==============================================================================
+
+    ArpChord.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#include "ArpChord.h"
+
+ArpChord ArpChord::fromNotes (const juce::Array<int>& heldNotes) noexcept
+{
+    ArpChord chord;
+    for (auto note : heldNotes)
+        chord.add (note);
+
+    return chord;
+}
+
+ArpChord ArpChord::fromPitchClasses (const juce::Array<int>& heldNotes) noexcept
+{
+    ArpChord chord;
+    for (auto note : heldNotes)
+        if ((chord.pitchClasses & (1 << getPitchClass (note))) == 0)
+            chord.add (getPitchClass (note));
+
+    return chord;
+}
+
+ArpChord ArpChord::fromDegrees (const MidiTools::Chord& chord)
+{
+    return fromNotes (chord.getDegrees());
+}
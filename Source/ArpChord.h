@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    ArpChord.h
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "libs/cppMusicTools/MidiTools.h"
+
+//==============================================================================
+/**
+    A chord as the lanes play it: up to 16 notes held inline, with the set of
+    their pitch classes.
+
+    It has no name and owns no memory, so it is trivially copyable: building
+    one on the audio thread and handing it to every lane is a copy of a few
+    bytes, never an allocation. Depending on the chord method, the notes are
+    MIDI notes, or degrees in semitones that the lanes play from their base
+    octave.
+*/
+struct ArpChord
+{
+    static constexpr int maxNumNotes = 16;
+
+    std::array<juce::int8, maxNumNotes> notes {};   // In the order they were added
+    juce::uint8 numNotes = 0;
+    juce::uint16 pitchClasses = 0;                  // One bit per pitch class of the notes
+
+    int size() const noexcept                       { return numNotes; }
+    bool isEmpty() const noexcept                   { return numNotes == 0; }
+    int operator[] (int index) const noexcept       { return notes[(size_t) index]; }
+
+    /** The pitch class of the first note, or -1 if the chord is empty. */
+    int getRootPitchClass() const noexcept          { return numNotes > 0 ? getPitchClass (notes[0]) : -1; }
+
+    /** Adds a note, if there is room for it. */
+    void add (int note) noexcept
+    {
+        if (numNotes < maxNumNotes)
+        {
+            notes[numNotes++] = (juce::int8) juce::jlimit (-128, 127, note);
+            pitchClasses |= (juce::uint16) (1 << getPitchClass (note));
+        }
+    }
+
+    /** The held notes, as they are ("Chord played as is"). */
+    static ArpChord fromNotes (const juce::Array<int>& heldNotes) noexcept;
+
+    /** The pitch classes of the held notes, each once, in the order they were
+        pressed ("Notes played"). */
+    static ArpChord fromPitchClasses (const juce::Array<int>& heldNotes) noexcept;
+
+    /** The degrees of a chord of the library, for tables built off the audio thread. */
+    static ArpChord fromDegrees (const MidiTools::Chord& chord);
+
+    static int getPitchClass (int note) noexcept    { return (note % 12 + 12) % 12; }
+};
+
+static_assert (std::is_trivially_copyable<ArpChord>::value, "ArpChord is copied into every lane on the audio thread");
@@ -0,0 +1,322 @@
+/*
+  ==============================================================================
+
+    ArpEngine.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#include "ArpEngine.h"
+
+void ArpEngine::setPattern (const ArpPattern* newPattern) noexcept
+{
+    pattern = newPattern;
+
+    // Keep the current position in the new pattern, so a lane that is playing
+    // does not jump back to its first step whenever its pattern is edited.
+    // The groups of the old pattern are left.
+    position.depth = 0;
+
+    if (pattern == nullptr || pattern->getNumSteps() == 0)
+    {
+        position.nextStep = 0;
+        return;
+    }
+
+    position.nextStep %= pattern->getNumSteps();
+}
+
+void ArpEngine::setRandomSeed (juce::uint64 seed, int laneIndex) noexcept
+{
+    random = CounterRandom (seed, (juce::uint64) laneIndex);
+}
+
+void ArpEngine::updateSwingTicks() noexcept
+{
+    // At 100%, the odd steps are half a step late.
+    swingTicks = ticksPerStep * swingPercent / 200;
+}
+
+int ArpEngine::getTicksForSubdivision (int subdivisionIndex) noexcept
+{
+    // "1/4", "1/4T", "1/8", "1/8T", "1/16", "1/16T", "1/32", "1/32T", "1/64", "1/64T"
+    static constexpr int q = TransportTracker::ticksPerQuarterNote;
+    static constexpr int ticks[] = { q, q * 2 / 3, q / 2, q / 3, q / 4, q / 6, q / 8, q / 12, q / 16, q / 24 };
+
+    static_assert (q % 48 == 0, "Every subdivision must be a whole number of ticks");
+
+    return ticks[juce::jlimit (0, (int) std::size (ticks) - 1, subdivisionIndex)];
+}
+
+void ArpEngine::setChord (const ArpChord& newChord) noexcept
+{
+    // The chord may come before the block that would pick up a new method,
+    // and the method sets the octave of the chord.
+    chordMethod = requestedChordMethod.load (std::memory_order_relaxed);
+    chord = newChord;
+    updatePitchTable();
+}
+
+void ArpEngine::setGlobalVelocityFromMidi (juce::uint8 velocity) noexcept
+{
+    globalVelocity = juce::jmax (1, (int) velocity);
+}
+
+void ArpEngine::setBaseOctaveFromNote (int note) noexcept
+{
+    baseOctave = note / 12;
+}
+
+void ArpEngine::updatePitchTable() noexcept
+{
+    // "Chord played as is" plays the notes that are held, the other methods
+    // play the chord degrees (in semitones) from the base octave.
+    const int offset = (chordMethod == 1) ? 0 : 12 * baseOctave;
+
+    std::array<int, ArpChord::maxNumNotes> notes;
+    numChordNotes = chord.size();
+
+    for (int i = 0; i < numChordNotes; ++i)
+        notes[(size_t) i] = juce::jlimit (0, 127, chord[i] + offset);
+
+    std::sort (notes.begin(), notes.begin() + numChordNotes);
+
+    // The octave modifiers count from the chord as it is, so a dropped note
+    // does sound below it.
+    chordOctave = (numChordNotes == 0 ? 12 * baseOctave : notes[0]) / 12 - 1;
+
+    switch (voicing)
+    {
+        case Voicing::close:
+            break;
+        case Voicing::spread:
+            for (int i = 1; i < numChordNotes; i += 2)
+                notes[(size_t) i] += 12;
+            break;
+        case Voicing::drop2:
+            if (numChordNotes >= 3)
+                notes[(size_t) numChordNotes - 2] -= 12;
+            break;
+    }
+
+    std::sort (notes.begin(), notes.begin() + numChordNotes);
+
+    // A voiced chord can span more than an octave: each row of the table then
+    // starts above the end of the one below, so the degrees keep going up.
+    auto rowSpan = 12;
+    if (voicing != Voicing::close && numChordNotes > 0)
+        rowSpan *= (notes[(size_t) numChordNotes - 1] - notes[0] + 12) / 12;
+
+    for (int octave = 0; octave < numOctaves; ++octave)
+        for (int i = 0; i < numChordNotes; ++i)
+            pitchTable[(size_t) (octave * numChordNotes + i)]
+                = (juce::uint8) juce::jlimit (0, 127, notes[(size_t) i] + rowSpan * (octave + lowestOctave - chordOctave));
+}
+
+void ArpEngine::processBlock (juce::MidiBuffer& output, const TransportTracker& transport,
+                              int startSample, int endSample, int midiChannel)
+{
+    blockStartSample = transport.getBlockStartSample();
+    applyRequestedSettings();
+
+    if (pattern != nullptr && pattern->getNumSteps() > 0)
+    {
+        transport.forEachStep (ticksPerStep, swingTicks, startSample, endSample, lastStep, [&] (int samplePosition, juce::int64 clockStep)
+        {
+            releaseNotesBefore (output, samplePosition + 1);
+            playStep (output, transport, samplePosition, clockStep, midiChannel);
+        });
+    }
+
+    releaseNotesBefore (output, endSample);
+}
+
+void ArpEngine::applyRequestedSettings() noexcept
+{
+    ticksPerStep = getTicksForSubdivision (requestedSubdivision.load (std::memory_order_relaxed));
+    gatePercent = juce::jlimit (1, 100, requestedGatePercent.load (std::memory_order_relaxed));
+    swingPercent = juce::jlimit (0, 100, requestedSwingPercent.load (std::memory_order_relaxed));
+    updateSwingTicks();
+
+    if (resetRequested.exchange (false, std::memory_order_relaxed))
+        reset();
+
+    // The method and the voicing both change the notes of the table.
+    const auto newChordMethod = requestedChordMethod.load (std::memory_order_relaxed);
+    const auto newVoicing = requestedVoicing.load (std::memory_order_relaxed);
+    if (newChordMethod != chordMethod || newVoicing != voicing)
+    {
+        chordMethod = newChordMethod;
+        voicing = newVoicing;
+        updatePitchTable();
+    }
+}
+
+void ArpEngine::playStep (juce::MidiBuffer& output, const TransportTracker& transport,
+                          int samplePosition, juce::int64 clockStep, int midiChannel)
+{
+    // Global modifiers and group boundaries take no time: go through them up
+    // to the step to play.
+    const auto stepIndex = pattern->advance (position, [this] (int firstGlobal, int numGlobals)
+    {
+        applyGlobals (firstGlobal, numGlobals);
+    });
+
+    if (stepIndex < 0)
+        return;
+
+    const auto& step = pattern->getStep (stepIndex);
+    currentStep = stepIndex;
+
+    int degree = lastDegree;
+
+    switch (step.op)
+    {
+        case ArpPattern::Op::sustain:       return;
+        case ArpPattern::Op::rest:          releaseAllNotes (output, samplePosition); return;
+        case ArpPattern::Op::note:          degree = step.degree; break;
+        case ArpPattern::Op::relativeNote:  degree = lastDegree + step.degree; break;
+        case ArpPattern::Op::random:        degree = random.getInt ((juce::uint64) clockStep, numChordNotes); break;
+        default:                            return;
+    }
+
+    lastDegree = degree;
+
+    // Whatever is still sounding ends here.
+    releaseAllNotes (output, samplePosition);
+
+    const auto note = resolveNote (step, degree);
+    if (note < 0)
+        return;
+
+    // At full gate, the note is held until the next step that is not a
+    // sustain, whenever it comes. Otherwise it is released after its share of
+    // the time until then, at the current tempo.
+    auto dueTime = NoteOffQueue::untilNextStep;
+
+    if (gatePercent < 100)
+    {
+        auto next = position;
+        int numSteps = 1;
+
+        while (numSteps < pattern->getNumSteps())
+        {
+            const auto nextIndex = pattern->advance (next, [] (int, int) {});
+            if (nextIndex < 0 || pattern->getStep (nextIndex).op != ArpPattern::Op::sustain)
+                break;
+
+            ++numSteps;
+        }
+
+        const auto noteTicks = TransportTracker::getStepTick (clockStep + numSteps, ticksPerStep, swingTicks)
+                             - TransportTracker::getStepTick (clockStep, ticksPerStep, swingTicks);
+        const auto noteSamples = (double) noteTicks * gatePercent / 100.0 / transport.getTicksPerSampleAt (samplePosition);
+
+        dueTime = blockStartSample + samplePosition + juce::jmax ((juce::int64) 1, (juce::int64) std::llround (noteSamples));
+    }
+
+    // A note whose release cannot be scheduled is not played, rather than
+    // left sounding.
+    if (! noteOffs.add (dueTime, note, midiChannel))
+        return;
+
+    output.addEvent (juce::MidiMessage::noteOn (midiChannel, note, (juce::uint8) resolveVelocity (step)), samplePosition);
+    lastPlayedNote = note;
+}
+
+void ArpEngine::applyGlobals (int firstGlobal, int numGlobals) noexcept
+{
+    for (int i = firstGlobal; i < firstGlobal + numGlobals; ++i)
+    {
+        const auto& global = pattern->getGlobal (i);
+
+        switch (global.op)
+        {
+            case ArpPattern::Op::setVelocity:
+                globalVelocity = juce::jmin (127, global.value * 16);
+                break;
+            case ArpPattern::Op::addVelocity:
+                globalVelocity = juce::jlimit (1, 127, globalVelocity + global.value * 16);
+                break;
+            case ArpPattern::Op::setOctave:
+                globalOctave = global.value;
+                break;
+            case ArpPattern::Op::addOctave:
+                globalOctave = juce::jlimit (0, 9, (globalOctave >= 0 ? globalOctave : chordOctave) + global.value);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+int ArpEngine::resolveNote (const ArpPattern::Step& step, int degree) const noexcept
+{
+    if (numChordNotes == 0)
+        return -1;
+
+    int octave = step.octave >= 0 ? step.octave
+                                  : (globalOctave >= 0 ? globalOctave : chordOctave);
+    octave += step.octaveDelta;
+
+    // Degrees past the end of the chord run on into the next octaves of the table.
+    const int index = juce::jlimit (0, numOctaves * numChordNotes - 1, (octave - lowestOctave) * numChordNotes + degree);
+    return juce::jlimit (0, 127, pitchTable[(size_t) index] + step.semitones);
+}
+
+int ArpEngine::resolveVelocity (const ArpPattern::Step& step) const noexcept
+{
+    const int velocity = step.velocityLevel > 0 ? juce::jmin (127, step.velocityLevel * 16)
+                                                : globalVelocity;
+    return juce::jlimit (1, 127, velocity + step.velocityDelta * 16);
+}
+
+void ArpEngine::sendNoteOff (juce::MidiBuffer& output, int noteNumber, int midiChannel, int samplePosition)
+{
+    output.addEvent (juce::MidiMessage::noteOff (midiChannel, noteNumber), samplePosition);
+
+    if (noteNumber == lastPlayedNote)
+        lastPlayedNote = -1;
+}
+
+void ArpEngine::releaseNotesBefore (juce::MidiBuffer& output, int samplePosition)
+{
+    noteOffs.releaseBefore (blockStartSample + samplePosition, [&] (int noteNumber, int midiChannel, juce::int64 dueTime)
+    {
+        sendNoteOff (output, noteNumber, midiChannel, (int) juce::jmax ((juce::int64) 0, dueTime - blockStartSample));
+    });
+}
+
+void ArpEngine::releaseAllNotes (juce::MidiBuffer& output, int samplePosition)
+{
+    noteOffs.releaseAll ([&] (int noteNumber, int midiChannel, juce::int64)
+    {
+        sendNoteOff (output, noteNumber, midiChannel, samplePosition);
+    });
+}
+
+void ArpEngine::turnOff (juce::MidiBuffer& output, int samplePosition)
+{
+    releaseAllNotes (output, samplePosition);
+
+    // The next chord starts from the top of the pattern, on the next step of
+    // the clock (the processor restarts the clock on it while the host is stopped).
+    position = {};
+    lastDegree = 0;
+}
+
+void ArpEngine::reset (juce::MidiBuffer& output, int samplePosition)
+{
+    releaseAllNotes (output, samplePosition);
+    reset();
+}
+
+void ArpEngine::reset() noexcept
+{
+    // The sounding notes, if any, are left for their scheduled release.
+    position = {};
+    lastDegree = 0;
+    globalOctave = -1;
+}
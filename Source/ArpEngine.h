@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    ArpEngine.h
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "libs/cppMusicTools/MidiTools.h"
+#include "ArpPattern.h"
+#include "TransportTracker.h"
+#include "NoteOffQueue.h"
+#include "ArpChord.h"
+#include "CounterRandom.h"
+
+//==============================================================================
+/**
+    One arpeggiator lane.
+
+    The engine plays a compiled ArpPattern over the current chord. It never
+    owns the pattern: the processor keeps it alive and swaps it in at block
+    boundaries (see PatternHandoff), so nothing here parses or frees patterns
+    on the audio thread.
+
+    Each time the chord changes, its notes are voiced and laid out in a table
+    of every degree in every octave, so a step finds its note with one lookup.
+*/
+class ArpEngine
+{
+public:
+    /** How the notes of the chord are stacked before they are played. */
+    enum class Voicing
+    {
+        close,      // As the chord is
+        spread,     // Every other note one octave up
+        drop2       // The second highest note one octave down
+    };
+
+    ArpEngine() = default;
+
+    void setPattern (const ArpPattern* newPattern) noexcept;
+    const ArpPattern* getPattern() const noexcept               { return pattern; }
+
+    // The settings below can be changed from any thread while the lane plays:
+    // it picks them up at the start of its next block.
+
+    void setSubdivision (int newSubdivision) noexcept           { requestedSubdivision = newSubdivision; }
+
+    /** The part of the time until the next step that a note sounds, from 1 to 100%. */
+    void setGate (int newGatePercent) noexcept                  { requestedGatePercent = newGatePercent; }
+
+    /** How late the odd steps are, from 0 to 100% of half a step. */
+    void setSwing (int newSwingPercent) noexcept                { requestedSwingPercent = newSwingPercent; }
+
+    /** The lane voices its chord again at the start of its next block. */
+    void setVoicing (Voicing newVoicing) noexcept               { requestedVoicing = newVoicing; }
+
+    void setChordMethod (int newChordMethod) noexcept           { requestedChordMethod = newChordMethod; }
+
+    /** Resets the pattern position and its globals at the start of the next block. */
+    void requestReset() noexcept                                { resetRequested = true; }
+
+    /** The random degrees of `?` steps depend on the seed, the lane and the
+        step of the clock they fall on, and nothing else. */
+    void setRandomSeed (juce::uint64 seed, int laneIndex) noexcept;
+
+    void setChord (const ArpChord& newChord) noexcept;
+    const ArpChord& getChord() const noexcept                   { return chord; }
+
+    void setGlobalVelocityFromMidi (juce::uint8 velocity) noexcept;
+    void setBaseOctaveFromNote (int note) noexcept;
+
+    /** Plays the steps that fall on the clock's ticks between two samples of
+        the block, and adds their notes to `output`. Nothing is allocated as
+        long as the buffer has room for the events. */
+    void processBlock (juce::MidiBuffer& output, const TransportTracker& transport,
+                       int startSample, int endSample, int midiChannel);
+
+    /** Releases all the sounding notes and rewinds to the start of the pattern. */
+    void turnOff (juce::MidiBuffer& output, int samplePosition);
+
+    /** Releases all the sounding notes and resets the pattern position and its globals. */
+    void reset (juce::MidiBuffer& output, int samplePosition);
+
+    int getCurrentStepIndex() const noexcept                    { return currentStep; }
+    int getLastPlayedNote() const noexcept                      { return lastPlayedNote; }
+
+    /** Returns the length of a step in ticks of the TransportTracker's clock
+        for a subdivision index. */
+    static int getTicksForSubdivision (int subdivision) noexcept;
+
+private:
+    void applyRequestedSettings() noexcept;
+    void reset() noexcept;
+    void updatePitchTable() noexcept;
+    void updateSwingTicks() noexcept;
+    void playStep (juce::MidiBuffer& output, const TransportTracker& transport,
+                   int samplePosition, juce::int64 clockStep, int midiChannel);
+    void applyGlobals (int firstGlobal, int numGlobals) noexcept;
+    int resolveNote (const ArpPattern::Step& step, int degree) const noexcept;
+    int resolveVelocity (const ArpPattern::Step& step) const noexcept;
+    void sendNoteOff (juce::MidiBuffer& output, int noteNumber, int midiChannel, int samplePosition);
+    void releaseNotesBefore (juce::MidiBuffer& output, int samplePosition);
+    void releaseAllNotes (juce::MidiBuffer& output, int samplePosition);
+
+    const ArpPattern* pattern = nullptr;
+    ArpPattern::Position position;
+    int currentStep = 0;
+
+    int ticksPerStep = getTicksForSubdivision (4);
+    int swingTicks = 0;
+    int gatePercent = 100;
+    int swingPercent = 0;
+    std::atomic<int> requestedSubdivision { 4 };
+    std::atomic<int> requestedGatePercent { 100 };
+    std::atomic<int> requestedSwingPercent { 0 };
+
+    int chordMethod = 1;
+    std::atomic<int> requestedChordMethod { 1 };
+    std::atomic<bool> resetRequested { false };
+    ArpChord chord;
+    int baseOctave = 5;
+
+    // The voiced notes of the chord in octaves -1 to 9, degree after degree:
+    // the note of a degree in an octave is at (octave + 1) * numChordNotes + degree.
+    static constexpr int lowestOctave = -1;
+    static constexpr int numOctaves = 11;
+    std::array<juce::uint8, numOctaves * ArpChord::maxNumNotes> pitchTable {};
+    int numChordNotes = 0;
+    int chordOctave = 4;            // The octave of the lowest note of the chord, before voicing
+    Voicing voicing = Voicing::close;
+    std::atomic<Voicing> requestedVoicing { Voicing::close };
+
+    int lastDegree = 0;
+    int globalVelocity = 100;
+    int globalOctave = -1;          // -1 = play the chord in its own octave
+    int lastPlayedNote = -1;
+
+    // The notes that are sounding, by the time they are released
+    NoteOffQueue noteOffs;
+    juce::int64 blockStartSample = 0;
+
+    // Where the last step fell on the clock, so no step is played twice
+    TransportTracker::LastStep lastStep;
+
+    CounterRandom random;
+
+    JUCE_LEAK_DETECTOR (ArpEngine)
+};
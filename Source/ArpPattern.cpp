@@ -0,0 +1,285 @@
+/*
+  ==============================================================================
+
+    ArpPattern.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#include "ArpPattern.h"
+
+// The audio thread reads one of these per step
+static_assert (sizeof (ArpPattern::Step) == 16, "A step should stay a small fixed-size record");
+
+namespace
+{
+    // What a character of the pattern is, looked up in one table instead of
+    // going through a chain of comparisons for each character.
+    enum class CharClass : juce::uint8
+    {
+        other,          // Ignored, but starts the span of the next step
+        whitespace,
+        step,           // Plays a step: `op` and `value` give what it plays
+        sharp,
+        flat,
+        velocity,       // `value` is 1 for the global modifier (V), 0 for the local one (v)
+        octave,         // `value` is 1 for the global modifier (O), 0 for the local one (o)
+        groupStart,
+        groupEnd        // May be followed by a repeat count: `)x4`
+    };
+
+    struct CharInfo
+    {
+        CharClass type = CharClass::other;
+        ArpPattern::Op op = ArpPattern::Op::rest;
+        juce::int8 value = 0;
+    };
+
+    constexpr std::array<CharInfo, 128> makeCharTable()
+    {
+        std::array<CharInfo, 128> table {};
+
+        for (auto c : { ' ', '\t', '\n', '\r', '\v', '\f' })
+            table[(size_t) c].type = CharClass::whitespace;
+
+        for (char c = '0'; c <= '9'; ++c)
+            table[(size_t) c] = { CharClass::step, ArpPattern::Op::note, (juce::int8) (c - '0') };
+
+        table['_'] = { CharClass::step, ArpPattern::Op::sustain, 0 };
+        table['.'] = { CharClass::step, ArpPattern::Op::rest, 0 };
+        table['+'] = { CharClass::step, ArpPattern::Op::relativeNote, 1 };
+        table['-'] = { CharClass::step, ArpPattern::Op::relativeNote, -1 };
+        table['='] = { CharClass::step, ArpPattern::Op::relativeNote, 0 };
+        table['?'] = { CharClass::step, ArpPattern::Op::random, 0 };
+        table['#'].type = CharClass::sharp;
+        table['b'].type = CharClass::flat;
+        table['v'] = { CharClass::velocity, ArpPattern::Op::rest, 0 };
+        table['V'] = { CharClass::velocity, ArpPattern::Op::rest, 1 };
+        table['o'] = { CharClass::octave, ArpPattern::Op::rest, 0 };
+        table['O'] = { CharClass::octave, ArpPattern::Op::rest, 1 };
+        table['('].type = CharClass::groupStart;
+        table[')'].type = CharClass::groupEnd;
+
+        return table;
+    }
+
+    constexpr auto charTable = makeCharTable();
+
+    CharInfo classify (juce::juce_wchar c) noexcept
+    {
+        if ((juce::uint32) c < charTable.size())
+            return charTable[(size_t) c];
+
+        return { juce::CharacterFunctions::isWhitespace (c) ? CharClass::whitespace : CharClass::other };
+    }
+
+    juce::uint16 toPosition (int index) noexcept
+    {
+        return (juce::uint16) juce::jlimit (0, 0xffff, index);
+    }
+}
+
+ArpPattern::Ptr ArpPattern::compile (const juce::String& patternText)
+{
+    Ptr pattern (new ArpPattern());
+    pattern->text = patternText;
+
+    // Indexing a juce::String walks its UTF-8 text, so go through UTF-32.
+    const auto chars = patternText.toUTF32();
+    const auto length = patternText.length();
+
+    Step pending;                   // Collects the local modifiers of the next step
+    int spanStart = -1;             // Start of the step being parsed, -1 if none
+    int firstGlobal = 0;            // First global modifier of the step being parsed
+    int numPlayingSteps = 0;
+
+    // The groups that are open, by the index of their start
+    std::array<int, maxGroupDepth> openGroups {};
+    int numOpenGroups = 0;
+    int numIgnoredGroups = 0;       // Opened past maxGroupDepth
+
+    auto addGlobal = [&pattern] (Op op, int value)
+    {
+        pattern->globals.add ({ op, (juce::int8) value });
+    };
+
+    auto addStep = [&] (Op op, int degree, int end)
+    {
+        pending.op = op;
+        pending.degree = (juce::int8) degree;
+        pending.firstGlobal = toPosition (firstGlobal);
+        pending.numGlobals = toPosition (pattern->globals.size() - firstGlobal);
+        pending.sourceStart = toPosition (spanStart);
+        pending.sourceEnd = toPosition (end);
+        pattern->steps.add (pending);
+        pending = {};
+        spanStart = -1;
+        firstGlobal = pattern->globals.size();
+        ++numPlayingSteps;
+    };
+
+    // The local modifiers written before a group boundary are kept for the
+    // step that follows it.
+    auto addGroupBoundary = [&] (Op op, int repeats, int end)
+    {
+        Step boundary;
+        boundary.op = op;
+        boundary.repeats = (juce::uint8) repeats;
+        boundary.firstGlobal = toPosition (firstGlobal);
+        boundary.numGlobals = toPosition (pattern->globals.size() - firstGlobal);
+        boundary.sourceStart = toPosition (spanStart);
+        boundary.sourceEnd = toPosition (end);
+        pattern->steps.add (boundary);
+        spanStart = -1;
+        firstGlobal = pattern->globals.size();
+    };
+
+    auto closeGroup = [&] (int repeats, int end)
+    {
+        const int start = openGroups[(size_t) --numOpenGroups];
+        auto& steps = pattern->steps;
+
+        // A group without a step would only have its globals to repeat: it
+        // is played once, as if it were not grouped, and its start goes with
+        // the globals to the next step.
+        if (start == steps.size() - 1)
+        {
+            firstGlobal = steps.getReference (start).firstGlobal;
+            spanStart = steps.getReference (start).sourceStart;
+            steps.removeLast();
+            return;
+        }
+
+        steps.getReference (start).repeats = (juce::uint8) repeats;
+        addGroupBoundary (Op::groupEnd, repeats, end);
+    };
+
+    for (int i = 0; i < length; ++i)
+    {
+        const auto info = classify (chars[i]);
+        const auto nextChar = i + 1 < length ? chars[i + 1] : 0;
+
+        if (info.type == CharClass::whitespace)
+            continue;
+
+        if (spanStart < 0)
+            spanStart = i;
+
+        switch (info.type)
+        {
+            case CharClass::step:
+                addStep (info.op, info.value, i + 1);
+                break;
+
+            case CharClass::sharp:
+                pending.semitones = (juce::int8) juce::jmin (12, pending.semitones + 1);
+                break;
+
+            case CharClass::flat:
+                pending.semitones = (juce::int8) juce::jmax (-12, pending.semitones - 1);
+                break;
+
+            case CharClass::velocity:
+            case CharClass::octave:
+            {
+                const bool isVelocity = info.type == CharClass::velocity;
+                const bool isGlobal = info.value != 0;
+                const int maxValue = isVelocity ? 8 : 7;
+                const int minValue = isVelocity ? 1 : 0;
+
+                if (nextChar == '+' || nextChar == '-')
+                {
+                    const int delta = nextChar == '+' ? 1 : -1;
+                    ++i;
+
+                    if (isGlobal)
+                        addGlobal (isVelocity ? Op::addVelocity : Op::addOctave, delta);
+                    else if (isVelocity)
+                        pending.velocityDelta = (juce::int8) delta;
+                    else
+                        pending.octaveDelta = (juce::int8) delta;
+                }
+                else if (nextChar >= '0' && nextChar <= '9')
+                {
+                    const int value = juce::jlimit (minValue, maxValue, (int) (nextChar - '0'));
+                    ++i;
+
+                    if (isGlobal)
+                        addGlobal (isVelocity ? Op::setVelocity : Op::setOctave, value);
+                    else if (isVelocity)
+                        pending.velocityLevel = (juce::int8) value;
+                    else
+                        pending.octave = (juce::int8) value;
+                }
+                break;
+            }
+
+            case CharClass::groupStart:
+                if (numOpenGroups < maxGroupDepth)
+                {
+                    openGroups[(size_t) numOpenGroups++] = pattern->steps.size();
+                    addGroupBoundary (Op::groupStart, 1, i + 1);
+                }
+                else
+                {
+                    ++numIgnoredGroups;
+                }
+                break;
+
+            case CharClass::groupEnd:
+            {
+                // The repeat count, from 1 to 255, is 1 if it is missing.
+                int repeats = 1;
+
+                if ((nextChar == 'x' || nextChar == 'X') && i + 2 < length
+                     && juce::CharacterFunctions::isDigit (chars[i + 2]))
+                {
+                    repeats = 0;
+                    for (i += 2; i < length && juce::CharacterFunctions::isDigit (chars[i]); ++i)
+                        repeats = juce::jmin (255, repeats * 10 + (int) (chars[i] - '0'));
+                    --i;
+                    repeats = juce::jmax (1, repeats);
+                }
+
+                if (numIgnoredGroups > 0)
+                    --numIgnoredGroups;
+                else if (numOpenGroups > 0)
+                    closeGroup (repeats, i + 1);
+                break;
+            }
+
+            case CharClass::whitespace:
+            case CharClass::other:
+                break;
+        }
+    }
+
+    // Groups left open end with the pattern.
+    while (numOpenGroups > 0)
+        closeGroup (1, length);
+
+    // Without a step to play, the group boundaries would have nothing to
+    // lead to, and the globals are only ever trailing ones.
+    if (numPlayingSteps == 0)
+    {
+        pattern->steps.clearQuick();
+        firstGlobal = 0;
+    }
+
+    pattern->firstTrailingGlobal = firstGlobal;
+    return pattern;
+}
+
+juce::Range<int> ArpPattern::getSourceRangeForStep (int step) const noexcept
+{
+    if (steps.isEmpty())
+        return { 0, text.length() };
+
+    step = ((step % steps.size()) + steps.size()) % steps.size();
+
+    const int start = steps.getReference (step).sourceStart;
+    const int end = step + 1 < steps.size() ? (int) steps.getReference (step + 1).sourceStart : text.length();
+    return { start, juce::jmax (start, end) };
+}
@@ -0,0 +1,195 @@
+/*
+  ==============================================================================
+
+    ArpPattern.h
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    A compiled arpeggiator pattern.
+
+    The text pattern is compiled once, on the message thread, into one
+    fixed-size record per step, which holds everything needed to play the
+    step, and a side table of the global modifiers written before each step.
+    Once compiled a pattern is never modified, so the audio thread can play it
+    without parsing, allocating or locking.
+
+    Groups such as `(0 1 2)x4` are not unrolled: the group start and end are
+    records of their own, and a lane goes back to the start of the group
+    until it has played it the given number of times (see advance()). The
+    size of a compiled pattern follows the length of its text.
+*/
+class ArpPattern : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<ArpPattern>;
+
+    enum class Op : juce::uint8
+    {
+        // Step ops: each step of the arpeggiator plays one.
+        note,           // plays the degree given in `degree`
+        relativeNote,   // plays the last played degree plus `degree` (+, - and =)
+        random,         // plays a random degree of the chord
+        sustain,        // keeps the current note sounding
+        rest,           // silence
+
+        // Group boundaries: they take no time and are gone through on the way
+        // to the next step.
+        groupStart,     // `repeats` is the number of times the group plays
+        groupEnd,       // goes back to the start of the group until it has played `repeats` times
+
+        // Global modifiers: they take no time and change the lane state.
+        setVelocity,    // `value` is a velocity level (1-8)
+        addVelocity,    // `value` is +1 or -1 level
+        setOctave,      // `value` is an octave (0-7)
+        addOctave       // `value` is +1 or -1 octave
+    };
+
+    struct Step
+    {
+        Op op = Op::rest;
+        juce::int8 degree = 0;
+
+        // Local modifiers, only applied to the note played by this step.
+        juce::int8 semitones = 0;
+        juce::int8 velocityLevel = 0;   // 0 = use the global velocity
+        juce::int8 velocityDelta = 0;
+        juce::int8 octave = -1;         // -1 = use the global octave
+        juce::int8 octaveDelta = 0;
+
+        juce::uint8 repeats = 1;        // groupStart only
+
+        // Global modifiers written before the step, applied before it plays.
+        juce::uint16 firstGlobal = 0;
+        juce::uint16 numGlobals = 0;
+
+        // Position of the step (including its modifiers) in the pattern text.
+        // For a group, the position of its opening bracket, or of its closing
+        // bracket and repeat count.
+        juce::uint16 sourceStart = 0;
+        juce::uint16 sourceEnd = 0;
+    };
+
+    struct Global
+    {
+        Op op = Op::setVelocity;
+        juce::int8 value = 0;
+    };
+
+    /** Groups nested deeper than this are played as if they were not grouped. */
+    static constexpr int maxGroupDepth = 8;
+
+    /** Where a lane is in a pattern: the next record to run, and the groups
+        it is in with the number of times each one still has to play. */
+    struct Position
+    {
+        struct Group
+        {
+            juce::uint16 firstStep = 0;
+            juce::uint8 timesLeft = 0;
+        };
+
+        int nextStep = 0;
+        int depth = 0;
+        std::array<Group, maxGroupDepth> groups {};
+    };
+
+    /** Compiles a pattern string. Unknown characters are ignored. */
+    static Ptr compile (const juce::String& text);
+
+    const juce::String& getText() const noexcept                { return text; }
+
+    /** The number of records, including the group boundaries. */
+    int getNumSteps() const noexcept                            { return steps.size(); }
+    const Step& getStep (int step) const noexcept               { return steps.getReference (step); }
+    const Global& getGlobal (int index) const noexcept          { return globals.getReference (index); }
+
+    /** The global modifiers written after the last step, applied before the
+        first step when the pattern wraps around. */
+    int getFirstTrailingGlobal() const noexcept                 { return firstTrailingGlobal; }
+    int getNumTrailingGlobals() const noexcept                  { return globals.size() - firstTrailingGlobal; }
+
+    /** Moves a position to the next step that plays something (a note, a
+        sustain or a rest), through the group boundaries on the way, and
+        returns the index of that step, or -1 if the pattern has none.
+
+        applyGlobals (firstGlobal, numGlobals) is called for the global
+        modifiers of each record gone through, the returned step included, and
+        for the trailing ones when the pattern wraps around.
+    */
+    template <typename ApplyGlobals>
+    int advance (Position& position, ApplyGlobals&& applyGlobals) const noexcept
+    {
+        const int numSteps = steps.size();
+        if (numSteps == 0)
+            return -1;
+
+        // Every group holds a step, so one comes within two passes.
+        for (int i = 0; i <= 2 * numSteps; ++i)
+        {
+            if (position.nextStep >= numSteps)
+            {
+                position.nextStep = 0;
+                position.depth = 0;
+                applyGlobals (firstTrailingGlobal, getNumTrailingGlobals());
+            }
+
+            const int index = position.nextStep++;
+            const auto& step = steps.getReference (index);
+            applyGlobals ((int) step.firstGlobal, (int) step.numGlobals);
+
+            if (step.op == Op::groupStart)
+            {
+                if (position.depth < maxGroupDepth)
+                    position.groups[(size_t) position.depth++] = { (juce::uint16) (index + 1), step.repeats };
+            }
+            else if (step.op == Op::groupEnd)
+            {
+                // A lane whose pattern changed while it was inside a group
+                // may meet the end of a group it did not enter.
+                if (position.depth > 0)
+                {
+                    auto& group = position.groups[(size_t) position.depth - 1];
+
+                    if (group.timesLeft > 1)
+                    {
+                        --group.timesLeft;
+                        position.nextStep = group.firstStep;
+                    }
+                    else
+                    {
+                        --position.depth;
+                    }
+                }
+            }
+            else
+            {
+                return index;
+            }
+        }
+
+        return -1;
+    }
+
+    /** Returns the part of the pattern text to highlight while a step plays:
+        from the step to the next one, or to the end of the text. */
+    juce::Range<int> getSourceRangeForStep (int step) const noexcept;
+
+private:
+    ArpPattern() = default;
+
+    juce::String text;
+    juce::Array<Step> steps;
+    juce::Array<Global> globals;
+    int firstTrailingGlobal = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ArpPattern)
+};
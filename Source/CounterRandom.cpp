@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    CounterRandom.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#include "CounterRandom.h"
+
+CounterRandom::CounterRandom (juce::uint64 seed, juce::uint64 stream) noexcept
+    : key (mix (seed + goldenGamma * (stream + 1)))
+{
+}
+
+juce::uint64 CounterRandom::getBits (juce::uint64 counter) const noexcept
+{
+    return mix (key + goldenGamma * counter);
+}
+
+int CounterRandom::getInt (juce::uint64 counter, int maxValue) const noexcept
+{
+    if (maxValue <= 0)
+        return 0;
+
+    // The top 32 bits scaled to the range, rather than a modulo.
+    return (int) (((getBits (counter) >> 32) * (juce::uint64) maxValue) >> 32);
+}
+
+juce::uint64 CounterRandom::mix (juce::uint64 value) noexcept
+{
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+    CounterRandom.h
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    A counter-based random generator: each value is a hash of a key and of a
+    counter, such as the index of a step of the clock.
+
+    There is no sequence to walk through, so a value only depends on where it
+    is used, not on what was drawn before: a render, or a part of it played
+    again after a seek, gets the same values as long as the seed is the same.
+    The hash is the SplitMix64 finalizer, which takes a few multiplications.
+*/
+class CounterRandom
+{
+public:
+    /** Different streams of the same seed give unrelated values, e.g. one
+        stream per lane. */
+    explicit CounterRandom (juce::uint64 seed = 0, juce::uint64 stream = 0) noexcept;
+
+    /** 64 random bits for a counter. */
+    juce::uint64 getBits (juce::uint64 counter) const noexcept;
+
+    /** A random int from 0 to maxValue - 1 for a counter. */
+    int getInt (juce::uint64 counter, int maxValue) const noexcept;
+
+    /** Mixes the bits of a value, so that close values give unrelated results. */
+    static juce::uint64 mix (juce::uint64 value) noexcept;
+
+private:
+    static constexpr juce::uint64 goldenGamma = 0x9e3779b97f4a7c15ULL;
+
+    juce::uint64 key = 0;
+};
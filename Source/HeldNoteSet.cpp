@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    HeldNoteSet.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#include "HeldNoteSet.h"
+
+HeldNoteSet::HeldNoteSet()
+{
+    notesInPlayOrder.ensureStorageAllocated (numMidiNotes);
+}
+
+bool HeldNoteSet::contains (int noteNumber) const noexcept
+{
+    if (! juce::isPositiveAndBelow (noteNumber, numMidiNotes))
+        return false;
+
+    return (bits[(size_t) (noteNumber >> 6)] >> (noteNumber & 63)) & 1;
+}
+
+bool HeldNoteSet::add (int noteNumber) noexcept
+{
+    if (! juce::isPositiveAndBelow (noteNumber, numMidiNotes) || contains (noteNumber))
+        return false;
+
+    bits[(size_t) (noteNumber >> 6)] |= (juce::uint64) 1 << (noteNumber & 63);
+
+    // Append to the end of the list
+    previous[(size_t) noteNumber] = (juce::int8) last;
+    next[(size_t) noteNumber] = none;
+
+    if (last != none)
+        next[(size_t) last] = (juce::int8) noteNumber;
+    else
+        first = noteNumber;
+
+    last = noteNumber;
+    ++numNotes;
+    playOrderIsDirty = true;
+    return true;
+}
+
+bool HeldNoteSet::remove (int noteNumber) noexcept
+{
+    if (! contains (noteNumber))
+        return false;
+
+    bits[(size_t) (noteNumber >> 6)] &= ~((juce::uint64) 1 << (noteNumber & 63));
+
+    // Unlink from the list
+    const int before = previous[(size_t) noteNumber];
+    const int after = next[(size_t) noteNumber];
+
+    if (before != none)  next[(size_t) before] = (juce::int8) after;
+    else                 first = after;
+
+    if (after != none)   previous[(size_t) after] = (juce::int8) before;
+    else                 last = before;
+
+    --numNotes;
+    playOrderIsDirty = true;
+    return true;
+}
+
+void HeldNoteSet::clear() noexcept
+{
+    bits = {};
+    first = none;
+    last = none;
+    numNotes = 0;
+    playOrderIsDirty = true;
+}
+
+const juce::Array<int>& HeldNoteSet::getNotesInPlayOrder() const noexcept
+{
+    if (playOrderIsDirty)
+    {
+        // The storage holds every MIDI note, so this never reallocates.
+        notesInPlayOrder.clearQuick();
+        for (int note = first; note != none; note = next[(size_t) note])
+            notesInPlayOrder.add (note);
+
+        playOrderIsDirty = false;
+    }
+
+    return notesInPlayOrder;
+}
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    HeldNoteSet.h
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    The MIDI notes currently held, in the order they were pressed.
+
+    A 128-bit set tells whether a note is held. A doubly linked list threaded
+    through fixed arrays keeps the order in which the notes were pressed.
+    Adding and removing a note are O(1), and nothing allocates after
+    construction, so it can be used on the audio thread.
+*/
+class HeldNoteSet
+{
+public:
+    static constexpr int numMidiNotes = 128;
+
+    HeldNoteSet();
+
+    /** Adds a note, if it is not already held. Returns false if it was. */
+    bool add (int noteNumber) noexcept;
+
+    /** Removes a note, if it is held. Returns false if it was not. */
+    bool remove (int noteNumber) noexcept;
+
+    void clear() noexcept;
+
+    bool contains (int noteNumber) const noexcept;
+    bool isEmpty() const noexcept                   { return numNotes == 0; }
+    int size() const noexcept                       { return numNotes; }
+
+    /** The note that was pressed last, or -1 if no note is held. */
+    int getLast() const noexcept                    { return last; }
+
+    /** The held notes, in the order they were pressed.
+
+        The array is preallocated for all the MIDI notes and rebuilt in place,
+        only when the set has changed since the last call. It stays valid
+        until the next call to a non-const method.
+    */
+    const juce::Array<int>& getNotesInPlayOrder() const noexcept;
+
+private:
+    static constexpr juce::int8 none = -1;
+
+    std::array<juce::uint64, 2> bits {};
+    std::array<juce::int8, numMidiNotes> previous {};
+    std::array<juce::int8, numMidiNotes> next {};
+    int first = none;
+    int last = none;
+    int numNotes = 0;
+
+    mutable juce::Array<int> notesInPlayOrder;
+    mutable bool playOrderIsDirty = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HeldNoteSet)
+};
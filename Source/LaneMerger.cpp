@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    LaneMerger.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#include "LaneMerger.h"
+
+bool LaneMerger::isNoteOn (const juce::MidiMessageMetadata& event) noexcept
+{
+    // A note-on with a velocity of 0 is a note-off.
+    return event.numBytes >= 3 && (event.data[0] & 0xf0) == 0x90 && event.data[2] != 0;
+}
+
+void LaneMerger::append (juce::MidiBuffer& output, const juce::MidiMessageMetadata& event)
+{
+    // The layout MidiBuffer::addEvent writes: the sample position as an
+    // int32, the size as a uint16, then the bytes of the message.
+    const auto samplePosition = (juce::int32) event.samplePosition;
+    const auto numBytes = (juce::uint16) event.numBytes;
+
+    juce::uint8 header[sizeof (samplePosition) + sizeof (numBytes)];
+    std::memcpy (header, &samplePosition, sizeof (samplePosition));
+    std::memcpy (header + sizeof (samplePosition), &numBytes, sizeof (numBytes));
+
+    output.data.addArray (header, (int) sizeof (header));
+    output.data.addArray (event.data, event.numBytes);
+
+    jassert (output.getLastEventTime() == event.samplePosition);
+}
+
+void LaneMerger::merge (const juce::MidiBuffer* const* lanes, int numLanes, juce::MidiBuffer& output)
+{
+    jassert (numLanes <= maxNumLanes);
+    numLanes = juce::jmin (numLanes, maxNumLanes);
+
+    std::array<juce::MidiBufferIterator, maxNumLanes> heads, ends;
+    for (int i = 0; i < numLanes; ++i)
+    {
+        heads[(size_t) i] = lanes[i]->cbegin();
+        ends[(size_t) i] = lanes[i]->cend();
+    }
+
+    for (;;)
+    {
+        // The earliest sample position left in any lane
+        int samplePosition = std::numeric_limits<int>::max();
+        for (int i = 0; i < numLanes; ++i)
+            if (heads[(size_t) i] != ends[(size_t) i])
+                samplePosition = juce::jmin (samplePosition, (*heads[(size_t) i]).samplePosition);
+
+        if (samplePosition == std::numeric_limits<int>::max())
+            break;
+
+        // Everything but the note-ons first, then the note-ons, each in lane order.
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            const bool noteOns = pass == 1;
+
+            for (int i = 0; i < numLanes; ++i)
+            {
+                for (auto it = heads[(size_t) i]; it != ends[(size_t) i]; ++it)
+                {
+                    const auto event = *it;
+                    if (event.samplePosition != samplePosition)
+                        break;
+
+                    if (isNoteOn (event) == noteOns)
+                        append (output, event);
+                }
+            }
+        }
+
+        for (int i = 0; i < numLanes; ++i)
+            while (heads[(size_t) i] != ends[(size_t) i] && (*heads[(size_t) i]).samplePosition == samplePosition)
+                ++heads[(size_t) i];
+    }
+}
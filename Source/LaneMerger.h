@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    LaneMerger.h
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Merges the MIDI output of the arpeggiator lanes into one buffer.
+
+    Each lane's buffer is already sorted by sample position, so the lanes are
+    merged in a single pass that only ever appends to the output. The events
+    are appended to the buffer's data directly: MidiBuffer::addEvent looks
+    for its place from the start of the buffer, which would make the merge
+    quadratic in the number of events.
+
+    Events on the same sample keep the order of their lanes, except that all
+    the note-ons come after everything else: a note stopped and restarted on
+    the same sample, by the same lane or by another one on the same channel,
+    is never left hanging.
+*/
+class LaneMerger
+{
+public:
+    static constexpr int maxNumLanes = 16;
+
+    /** Adds the events of `numLanes` buffers to `output`, which should be
+        empty. Nothing is allocated if `output` has room for the events. */
+    static void merge (const juce::MidiBuffer* const* lanes, int numLanes, juce::MidiBuffer& output);
+
+private:
+    static bool isNoteOn (const juce::MidiMessageMetadata& event) noexcept;
+    static void append (juce::MidiBuffer& output, const juce::MidiMessageMetadata& event);
+
+    LaneMerger() = delete;
+};
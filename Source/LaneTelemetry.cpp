@@ -0,0 +1,26 @@
+/*
+  ==============================================================================
+
+    LaneTelemetry.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#include "LaneTelemetry.h"
+
+void LaneTelemetry::publish() noexcept
+{
+    // Hand the snapshot over and go on with the spare one, which the reader is not using.
+    writeIndex = spareIndex.exchange (writeIndex | newSnapshotBit, std::memory_order_acq_rel) & indexMask;
+}
+
+const LaneTelemetry::Snapshot& LaneTelemetry::read() noexcept
+{
+    // Only swap when there is something new, otherwise the reader would get an older snapshot back.
+    if ((spareIndex.load (std::memory_order_relaxed) & newSnapshotBit) != 0)
+        readIndex = spareIndex.exchange (readIndex, std::memory_order_acq_rel) & indexMask;
+
+    return snapshots[(size_t) readIndex];
+}
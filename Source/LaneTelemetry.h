@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    LaneTelemetry.h
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Passes what the editor shows from the audio thread to the message thread.
+
+    The audio thread fills in a snapshot once per block and publishes it; the
+    editor reads the latest one from its timer. The snapshots are triple
+    buffered: each thread owns one, and they swap the third one through a
+    single atomic, so neither thread ever waits or reads a snapshot that is
+    being written. Each snapshot sits on its own cache lines, so the editor
+    never touches the lines the audio thread is writing.
+*/
+class LaneTelemetry
+{
+public:
+    static constexpr int maxNumLanes = 16;
+
+    struct alignas (64) Snapshot
+    {
+        std::array<int, maxNumLanes> currentStep {};    // Step being played by each lane
+        std::array<int, maxNumLanes> lastNote {};       // Last note played by each lane, or -1
+        juce::uint32 activeLanes = 0;                   // One bit per lane that is on
+        juce::uint16 chordPitchClasses = 0;             // One bit per pitch class of the chord shown
+        int chordRoot = -1;                             // Pitch class of the first note of the chord, or -1
+        bool notesHeld = false;
+    };
+
+    LaneTelemetry() = default;
+
+    /** Audio thread: the snapshot to fill in before calling publish(). */
+    Snapshot& getSnapshotToWrite() noexcept                     { return snapshots[(size_t) writeIndex]; }
+
+    /** Audio thread: makes the snapshot that was filled in the latest one. */
+    void publish() noexcept;
+
+    /** Message thread: returns the latest published snapshot. It stays valid
+        until the next call. */
+    const Snapshot& read() noexcept;
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int newSnapshotBit = 4;
+
+    std::array<Snapshot, 3> snapshots {};
+    int writeIndex = 0;                                         // Audio thread only
+    int readIndex = 1;                                          // Message thread only
+    std::atomic<int> spareIndex { 2 };                          // Swapped by both, with newSnapshotBit once published
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LaneTelemetry)
+};
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    LaneWorkerPool.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#include "LaneWorkerPool.h"
+
+//==============================================================================
+class LaneWorkerPool::Worker : public juce::Thread
+{
+public:
+    Worker (LaneWorkerPool& ownerPool, int workerIndex)
+        : juce::Thread ("TeAr lane worker " + juce::String (workerIndex + 1)),
+          owner (ownerPool),
+          index (workerIndex)
+    {
+    }
+
+    ~Worker() override
+    {
+        stopThread (1000);
+    }
+
+    void run() override
+    {
+        // Keep each worker on its own core, away from the first one, which
+        // hosts usually give to their own audio thread.
+        const int numCores = juce::SystemStats::getNumCpus();
+        if (numCores > 1)
+            juce::Thread::setCurrentThreadAffinityMask ((juce::uint32) 1 << ((index + 1) % juce::jmin (32, numCores)));
+
+        auto lastRun = owner.getRunNumber();
+
+        while (! threadShouldExit())
+        {
+            // The audio thread starts a run by bumping the run number and
+            // nothing else, so it never takes a lock to wake a worker. Spin
+            // for a little while, so that a block following closely finds the
+            // worker awake, then look again every millisecond.
+            bool hasWork = false;
+            for (int spin = 0; ! hasWork && ! threadShouldExit(); ++spin)
+            {
+                hasWork = owner.getRunNumber() != lastRun;
+                if (hasWork)
+                    break;
+
+                if (spin < spinsBeforeSleeping)
+                    std::this_thread::yield();
+                else
+                    juce::Thread::sleep (sleepTimeMs);
+            }
+
+            if (hasWork)
+            {
+                lastRun = owner.getRunNumber();
+                owner.runAvailableJobs (lastRun);
+            }
+        }
+    }
+
+private:
+    static constexpr int spinsBeforeSleeping = 2000;
+    static constexpr int sleepTimeMs = 1;
+
+    LaneWorkerPool& owner;
+    const int index;
+};
+
+//==============================================================================
+LaneWorkerPool::LaneWorkerPool (int numWorkers)
+{
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto* worker = workers.add (new Worker (*this, i));
+        worker->startRealtimeThread (juce::Thread::RealtimeOptions{}.withPriority (9));
+    }
+}
+
+LaneWorkerPool::~LaneWorkerPool()
+{
+    workers.clear();
+}
+
+void LaneWorkerPool::run (Job& job, int numJobs) noexcept
+{
+    if (numJobs <= 0)
+        return;
+
+    jassert (numJobs <= 0xffff);
+
+    // The job is published before the counter that lets the workers take it.
+    currentJob.store (&job, std::memory_order_relaxed);
+    jobsRemaining.store (numJobs, std::memory_order_relaxed);
+
+    const auto runNumber = getRunNumber() + 1;
+    jobCounter.store (((juce::uint64) runNumber << 32) | ((juce::uint64) numJobs << 16), std::memory_order_release);
+
+    runAvailableJobs (runNumber);
+
+    // Whatever is left is already running on a worker.
+    while (jobsRemaining.load (std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+}
+
+void LaneWorkerPool::runAvailableJobs (juce::uint32 runNumber) noexcept
+{
+    auto counter = jobCounter.load (std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto index = (int) (counter & 0xffff);
+        const auto numJobs = (int) ((counter >> 16) & 0xffff);
+
+        if ((juce::uint32) (counter >> 32) != runNumber || index >= numJobs)
+            return;
+
+        // On failure, counter is reloaded and checked again.
+        if (jobCounter.compare_exchange_weak (counter, counter + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            currentJob.load (std::memory_order_relaxed)->runJob (index);
+            jobsRemaining.fetch_sub (1, std::memory_order_acq_rel);
+            counter = jobCounter.load (std::memory_order_acquire);
+        }
+    }
+}
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    LaneWorkerPool.h
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    A small pool of real-time threads that run independent jobs for the audio
+    thread, such as one arpeggiator lane each.
+
+    The audio thread never waits for a worker to wake up: it takes jobs from
+    the same counter as the workers, so a job is either done by the audio
+    thread itself or is already running on a worker when the audio thread
+    runs out of jobs. It then only spins until those running jobs are done.
+    Nor does it signal the workers, which would take a lock: they watch the
+    run number, spinning briefly for the next block, then polling it every
+    millisecond.
+*/
+class LaneWorkerPool
+{
+public:
+    /** The work to share between the threads. runJob() is called once for
+        each index, from any of the threads, and must not block. */
+    struct Job
+    {
+        virtual ~Job() = default;
+        virtual void runJob (int index) noexcept = 0;
+    };
+
+    explicit LaneWorkerPool (int numWorkers);
+    ~LaneWorkerPool();
+
+    int getNumWorkers() const noexcept                  { return workers.size(); }
+
+    /** Audio thread: runs job.runJob (0 .. numJobs - 1) on the workers and on
+        the calling thread, and returns when they are all done. */
+    void run (Job& job, int numJobs) noexcept;
+
+private:
+    class Worker;
+
+    void runAvailableJobs (juce::uint32 runNumber) noexcept;
+    juce::uint32 getRunNumber() const noexcept          { return (juce::uint32) (jobCounter.load (std::memory_order_acquire) >> 32); }
+
+    juce::OwnedArray<Worker> workers;
+
+    // The run number, the number of jobs and the next job to take, packed
+    // together so a worker that is late from a previous run cannot take a job
+    // from the current one.
+    std::atomic<juce::uint64> jobCounter { 0 };
+    std::atomic<int> jobsRemaining { 0 };
+    std::atomic<Job*> currentJob { nullptr };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LaneWorkerPool)
+};
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    NoteOffQueue.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#include "NoteOffQueue.h"
+
+bool NoteOffQueue::add (juce::int64 dueTime, int noteNumber, int midiChannel) noexcept
+{
+    if (numEvents == capacity)
+        return false;
+
+    events[(size_t) numEvents] = { dueTime, (juce::uint8) noteNumber, (juce::uint8) midiChannel };
+    siftUp (numEvents++);
+    return true;
+}
+
+void NoteOffQueue::removeAt (int index) noexcept
+{
+    // The last event takes the place of the removed one, then moves up or
+    // down to where it belongs.
+    events[(size_t) index] = events[(size_t) --numEvents];
+
+    if (index < numEvents)
+    {
+        siftUp (index);
+        siftDown (index);
+    }
+}
+
+void NoteOffQueue::siftUp (int index) noexcept
+{
+    while (index > 0)
+    {
+        const int parent = (index - 1) / 2;
+        if (events[(size_t) parent].dueTime <= events[(size_t) index].dueTime)
+            return;
+
+        std::swap (events[(size_t) parent], events[(size_t) index]);
+        index = parent;
+    }
+}
+
+void NoteOffQueue::siftDown (int index) noexcept
+{
+    for (;;)
+    {
+        const int left = 2 * index + 1;
+        const int right = left + 1;
+        int smallest = index;
+
+        if (left < numEvents && events[(size_t) left].dueTime < events[(size_t) smallest].dueTime)
+            smallest = left;
+        if (right < numEvents && events[(size_t) right].dueTime < events[(size_t) smallest].dueTime)
+            smallest = right;
+
+        if (smallest == index)
+            return;
+
+        std::swap (events[(size_t) smallest], events[(size_t) index]);
+        index = smallest;
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NoteOffQueueTests : public juce::UnitTest
+{
+public:
+    NoteOffQueueTests() : juce::UnitTest ("NoteOffQueue", "TeAr") {}
+
+    void runTest() override
+    {
+        beginTest ("A full queue refuses note-offs and keeps the ones it has");
+        {
+            NoteOffQueue queue;
+
+            // Due times out of order, so the heap has to sort them.
+            for (int i = 0; i < NoteOffQueue::capacity; ++i)
+                expect (queue.add ((i * 7) % NoteOffQueue::capacity, i, 1));
+
+            expect (! queue.add (0, 100, 1));
+            expect (! queue.add (NoteOffQueue::untilNextStep, 101, 1));
+
+            int numReleased = 0;
+            juce::int64 lastDueTime = -1;
+            queue.releaseBefore (NoteOffQueue::capacity, [&] (int noteNumber, int, juce::int64 dueTime)
+            {
+                expect (noteNumber < NoteOffQueue::capacity);
+                expect (dueTime >= lastDueTime);
+                lastDueTime = dueTime;
+                ++numReleased;
+            });
+
+            expectEquals (numReleased, NoteOffQueue::capacity);
+            expect (queue.add (0, 100, 1));
+        }
+
+        beginTest ("releaseAll empties a full queue");
+        {
+            NoteOffQueue queue;
+            for (int i = 0; i < NoteOffQueue::capacity; ++i)
+                queue.add (NoteOffQueue::untilNextStep, i, 1);
+
+            int numReleased = 0;
+            queue.releaseAll ([&] (int, int, juce::int64) { ++numReleased; });
+            expectEquals (numReleased, NoteOffQueue::capacity);
+
+            for (int i = 0; i < NoteOffQueue::capacity; ++i)
+                expect (queue.add (i, i, 1));
+        }
+    }
+};
+
+static NoteOffQueueTests noteOffQueueTests;
+
+#endif
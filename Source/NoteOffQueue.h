@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    NoteOffQueue.h
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    The note-offs a lane still has to send, by the sample they are due on.
+
+    A binary min-heap in a fixed array, keyed by absolute sample time (see
+    TransportTracker::getBlockStartSample()), so a release can be scheduled
+    any number of blocks ahead. Nothing allocates, and flushing the whole
+    queue, for an all-notes-off, is a single pass over the array.
+
+    ArpEngine releases whatever is sounding before each note it plays, so
+    its queue holds one note-off at a time; the capacity only matters if
+    notes are ever allowed to overlap.
+*/
+class NoteOffQueue
+{
+public:
+    static constexpr int capacity = 32;
+
+    /** Due time of a note held until the lane's next step, whenever it comes,
+        rather than until a given time. */
+    static constexpr juce::int64 untilNextStep = std::numeric_limits<juce::int64>::max();
+
+    NoteOffQueue() = default;
+
+    /** Schedules a note-off. Returns false if the queue is full, in which case
+        the caller should send the note-off straight away. */
+    bool add (juce::int64 dueTime, int noteNumber, int midiChannel) noexcept;
+
+    /** Calls release (noteNumber, midiChannel, dueTime) for each note-off due
+        before `time`, earliest first, and removes them. */
+    template <typename Callback>
+    void releaseBefore (juce::int64 time, Callback&& release)
+    {
+        while (numEvents > 0 && events[0].dueTime < time)
+        {
+            const auto event = events[0];
+            removeAt (0);
+            release ((int) event.noteNumber, (int) event.midiChannel, event.dueTime);
+        }
+    }
+
+    /** Calls release (noteNumber, midiChannel, dueTime) for every note-off,
+        in no particular order, and empties the queue. */
+    template <typename Callback>
+    void releaseAll (Callback&& release)
+    {
+        for (int i = 0; i < numEvents; ++i)
+            release ((int) events[(size_t) i].noteNumber, (int) events[(size_t) i].midiChannel, events[(size_t) i].dueTime);
+
+        numEvents = 0;
+    }
+
+private:
+    struct Event
+    {
+        juce::int64 dueTime;
+        juce::uint8 noteNumber;
+        juce::uint8 midiChannel;
+    };
+
+    void removeAt (int index) noexcept;
+    void siftUp (int index) noexcept;
+    void siftDown (int index) noexcept;
+
+    std::array<Event, capacity> events {};
+    int numEvents = 0;
+};
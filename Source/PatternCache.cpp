@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    PatternCache.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#include "PatternCache.h"
+
+JUCE_IMPLEMENT_SINGLETON (PatternCache)
+
+PatternCache::~PatternCache()
+{
+    clearSingletonInstance();
+}
+
+ArpPattern::Ptr PatternCache::findAndTouch (const juce::String& text, juce::int64 hash)
+{
+    const auto range = index.equal_range (hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if ((*it->second)->getText() == text)
+        {
+            // Move it to the front, as the most recently used.
+            entries.splice (entries.begin(), entries, it->second);
+            return entries.front();
+        }
+    }
+
+    return nullptr;
+}
+
+ArpPattern::Ptr PatternCache::getPattern (const juce::String& text)
+{
+    const auto hash = text.hashCode64();
+
+    {
+        const juce::ScopedLock sl (lock);
+        if (auto pattern = findAndTouch (text, hash))
+        {
+            ++hits;
+            return pattern;
+        }
+    }
+
+    // Compile without holding the lock, so other threads can use the cache meanwhile.
+    ++misses;
+    auto compiled = ArpPattern::compile (text);
+
+    const juce::ScopedLock sl (lock);
+
+    // Another thread may have compiled the same text in the meantime: share its pattern.
+    if (auto pattern = findAndTouch (text, hash))
+        return pattern;
+
+    entries.push_front (compiled);
+    index.emplace (hash, entries.begin());
+
+    if ((int) entries.size() > capacity)
+    {
+        const auto oldest = std::prev (entries.end());
+        const auto range = index.equal_range ((*oldest)->getText().hashCode64());
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second == oldest)
+            {
+                index.erase (it);
+                break;
+            }
+        }
+        entries.erase (oldest);
+    }
+
+    return compiled;
+}
+
+PatternCache::Statistics PatternCache::getStatistics() const
+{
+    const juce::ScopedLock sl (lock);
+    return { hits.load(), misses.load(), (int) entries.size() };
+}
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    PatternCache.h
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ArpPattern.h"
+
+//==============================================================================
+/**
+    Compiled patterns, shared by all the lanes of all the plugin instances.
+
+    A compiled pattern is never modified, so all the lanes that play the same
+    text can share one. The cache keeps the most recently used patterns, up to
+    a fixed number, so that recalling a session with many instances, or going
+    back to a pattern that was just edited, does not compile the same text
+    again. Patterns that are still in use stay alive after they leave the
+    cache, through their reference count.
+
+    Thread-safe, but it allocates and locks: not for the audio thread.
+*/
+class PatternCache : private juce::DeletedAtShutdown
+{
+public:
+    static constexpr int capacity = 256;
+
+    ~PatternCache() override;
+
+    /** Returns the compiled pattern for a text, compiling it if it is not in the cache. */
+    ArpPattern::Ptr getPattern (const juce::String& text);
+
+    struct Statistics
+    {
+        juce::uint64 hits = 0;
+        juce::uint64 misses = 0;
+        int numPatterns = 0;
+    };
+    Statistics getStatistics() const;
+
+    JUCE_DECLARE_SINGLETON (PatternCache, false)
+
+private:
+    PatternCache() = default;
+
+    ArpPattern::Ptr findAndTouch (const juce::String& text, juce::int64 hash);
+
+    // Most recently used first, with an index from the hash of the text.
+    // Different texts can share a hash, so the text is checked on a hit.
+    using Entries = std::list<ArpPattern::Ptr>;
+    Entries entries;
+    std::unordered_multimap<juce::int64, Entries::iterator> index;
+
+    juce::CriticalSection lock;
+    std::atomic<juce::uint64> hits { 0 }, misses { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PatternCache)
+};
@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+    PatternGenerator.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#include "PatternGenerator.h"
+
+namespace
+{
+    using PatternGenerator::maxEuclideanSteps;
+
+    constexpr juce::uint64 getAllStepsMask (int steps) noexcept
+    {
+        return steps >= 64 ? ~(juce::uint64) 0 : ((juce::uint64) 1 << steps) - 1;
+    }
+
+    // Bjorklund's algorithm. The rhythm starts as `hits` sequences "1" and
+    // `steps - hits` sequences "0"; while there is more than one sequence
+    // left over, each of the first sequences takes one of the others at its
+    // end. At every stage, all the first sequences are the same and so are
+    // all the others, so each kind is one mask and a count.
+    constexpr juce::uint64 makeEuclideanMask (int hits, int steps) noexcept
+    {
+        if (hits <= 0)
+            return 0;
+
+        if (hits >= steps)
+            return getAllStepsMask (steps);
+
+        juce::uint64 first = 1, other = 0;
+        int firstLength = 1, otherLength = 1;
+        int numFirst = hits, numOther = steps - hits;
+
+        while (numOther > 1)
+        {
+            const int numPairs = juce::jmin (numFirst, numOther);
+            const auto pair = first | (other << firstLength);
+            const int pairLength = firstLength + otherLength;
+
+            if (numFirst > numOther)
+            {
+                other = first;
+                otherLength = firstLength;
+                numOther = numFirst - numPairs;
+            }
+            else
+            {
+                numOther -= numPairs;
+            }
+
+            first = pair;
+            firstLength = pairLength;
+            numFirst = numPairs;
+        }
+
+        juce::uint64 mask = 0;
+        int length = 0;
+
+        for (int i = 0; i < numFirst; ++i, length += firstLength)
+            mask |= first << length;
+
+        for (int i = 0; i < numOther; ++i, length += otherLength)
+            mask |= other << length;
+
+        return mask;
+    }
+
+    // The rhythms of each length, one after the other, from 0 to all hits
+    constexpr int getTableIndex (int hits, int steps) noexcept
+    {
+        return (steps - 1) * (steps + 2) / 2 + hits;
+    }
+
+    constexpr int tableSize = getTableIndex (maxEuclideanSteps, maxEuclideanSteps) + 1;
+
+    constexpr std::array<juce::uint64, tableSize> makeEuclideanTable() noexcept
+    {
+        std::array<juce::uint64, tableSize> table {};
+
+        for (int steps = 1; steps <= maxEuclideanSteps; ++steps)
+            for (int hits = 0; hits <= steps; ++hits)
+                table[(size_t) getTableIndex (hits, steps)] = makeEuclideanMask (hits, steps);
+
+        return table;
+    }
+
+    constexpr auto euclideanTable = makeEuclideanTable();
+
+    static_assert (euclideanTable[(size_t) getTableIndex (3, 8)] == 0b01001001, "x..x..x.");
+    static_assert (euclideanTable[(size_t) getTableIndex (5, 8)] == 0b01101101, "x.xx.xx.");
+    static_assert (euclideanTable[(size_t) getTableIndex (64, 64)] == ~(juce::uint64) 0, "All hits");
+
+    juce::uint64 rotateMask (juce::uint64 mask, int steps, int rotation) noexcept
+    {
+        if (rotation == 0)
+            return mask;
+
+        return ((mask >> rotation) | (mask << (steps - rotation))) & getAllStepsMask (steps);
+    }
+}
+
+juce::uint64 PatternGenerator::getEuclideanMask (int hits, int steps, int rotation) noexcept
+{
+    steps = juce::jlimit (1, maxEuclideanSteps, steps);
+    hits = juce::jlimit (0, steps, hits);
+    rotation = ((rotation % steps) + steps) % steps;
+
+    return rotateMask (euclideanTable[(size_t) getTableIndex (hits, steps)], steps, rotation);
+}
+
+juce::Array<juce::uint64> PatternGenerator::getEuclideanRotations (int hits, int steps)
+{
+    steps = juce::jlimit (1, maxEuclideanSteps, steps);
+    hits = juce::jlimit (0, steps, hits);
+
+    const auto mask = euclideanTable[(size_t) getTableIndex (hits, steps)];
+
+    juce::Array<juce::uint64> rotations;
+    rotations.ensureStorageAllocated (steps);
+
+    for (int rotation = 0; rotation < steps; ++rotation)
+        rotations.add (rotateMask (mask, steps, rotation));
+
+    return rotations;
+}
+
+juce::Array<PatternGenerator::EuclideanRhythm> PatternGenerator::getEuclideanRhythms (int minSteps, int maxSteps)
+{
+    minSteps = juce::jlimit (1, maxEuclideanSteps, minSteps);
+    maxSteps = juce::jlimit (minSteps, maxEuclideanSteps, maxSteps);
+
+    // The rhythms are stored in this order, so this is a copy out of the table.
+    juce::Array<EuclideanRhythm> rhythms;
+    rhythms.ensureStorageAllocated (getTableIndex (maxSteps, maxSteps) + 1 - getTableIndex (0, minSteps));
+
+    for (int steps = minSteps; steps <= maxSteps; ++steps)
+        for (int hits = 0; hits <= steps; ++hits)
+            rhythms.add ({ hits, steps, euclideanTable[(size_t) getTableIndex (hits, steps)] });
+
+    return rhythms;
+}
+
+juce::String PatternGenerator::makePatternFromMask (juce::uint64 mask, int steps)
+{
+    steps = juce::jlimit (1, maxEuclideanSteps, steps);
+
+    juce::StringArray tokens;
+    for (int i = 0; i < steps; ++i)
+        tokens.add (((mask >> i) & 1) != 0 ? "0" : ".");
+
+    return tokens.joinIntoString (" ");
+}
+
+juce::String PatternGenerator::makeEuclidianPattern (int hits, int steps, int rotation)
+{
+    return makePatternFromMask (getEuclideanMask (hits, steps, rotation), juce::jlimit (1, maxEuclideanSteps, steps));
+}
+
+juce::String PatternGenerator::makeRandomPattern (juce::int64 seed)
+{
+    static const char* const modifiers[] = { "#", "b", "o+", "o-", "v+", "v-" };
+    static const char* const moves[] = { "+", "-", "?", "=" };
+
+    juce::Random random (seed);
+    const int numSteps = 8 + random.nextInt (9);
+
+    juce::StringArray tokens;
+    for (int i = 0; i < numSteps; ++i)
+    {
+        juce::String token;
+
+        if (random.nextInt (10) == 0)
+            token << modifiers[random.nextInt ((int) std::size (modifiers))];
+
+        const int choice = random.nextInt (100);
+        if (choice < 55 || i == 0)  token << juce::String (random.nextInt (5));
+        else if (choice < 70)       token << ".";
+        else if (choice < 80)       token << "_";
+        else                        token << moves[random.nextInt ((int) std::size (moves))];
+
+        tokens.add (token);
+    }
+
+    return tokens.joinIntoString (" ");
+}
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    PatternGenerator.h
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Pattern strings generated for the pattern popup and the randomize button.
+
+    These functions don't touch any arpeggiator, so they can be called from the
+    editor while the audio thread is playing.
+*/
+namespace PatternGenerator
+{
+    /** The longest Euclidean rhythm, so that a rhythm fits in a 64-bit mask. */
+    constexpr int maxEuclideanSteps = 64;
+
+    /** A Euclidean rhythm as a mask, where bit i is set if step i is a hit. */
+    struct EuclideanRhythm
+    {
+        int hits = 0;
+        int steps = 0;
+        juce::uint64 mask = 0;
+    };
+
+    /** Spreads `hits` hits as evenly as possible over `steps` steps (Bjorklund's
+        algorithm), starting `rotation` steps into the rhythm. The rhythms of
+        up to 64 steps are worked out at compile time, so this only looks up
+        a table and rotates the mask. */
+    juce::uint64 getEuclideanMask (int hits, int steps, int rotation) noexcept;
+
+    /** Every rotation of a rhythm, from 0 to steps - 1. */
+    juce::Array<juce::uint64> getEuclideanRotations (int hits, int steps);
+
+    /** Every rhythm from minSteps to maxSteps steps, with from 0 to all of
+        their steps as hits, unrotated. */
+    juce::Array<EuclideanRhythm> getEuclideanRhythms (int minSteps, int maxSteps);
+
+    /** A pattern playing the root on the hits of a mask and resting on its
+        other steps. */
+    juce::String makePatternFromMask (juce::uint64 mask, int steps);
+
+    /** Spreads `hits` root notes as evenly as possible over `steps` steps,
+        the other steps being rests. */
+    juce::String makeEuclidianPattern (int hits, int steps, int rotation);
+
+    /** Returns a random pattern mixing notes, rests, sustains and modifiers.
+        The same seed always gives the same pattern. */
+    juce::String makeRandomPattern (juce::int64 seed);
+}
@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    PatternHandoff.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#include "PatternHandoff.h"
+
+PatternHandoff::~PatternHandoff()
+{
+    releaseRetired();
+
+    if (auto* unused = pending.exchange (nullptr))
+        unused->decReferenceCount();
+
+    if (live != nullptr)
+        live->decReferenceCount();
+}
+
+void PatternHandoff::submit (ArpPattern::Ptr pattern)
+{
+    releaseRetired();
+
+    // The pending slot owns one reference, which moves to the audio thread
+    // when the pattern is acquired.
+    auto* incoming = pattern.get();
+    if (incoming != nullptr)
+        incoming->incReferenceCount();
+
+    // A pattern that was replaced before the audio thread saw it can be
+    // released right here.
+    if (auto* superseded = pending.exchange (incoming, std::memory_order_acq_rel))
+        superseded->decReferenceCount();
+}
+
+void PatternHandoff::releaseRetired()
+{
+    const auto scope = retiredFifo.read (retiredFifo.getNumReady());
+    scope.forEach ([this] (int index)
+    {
+        retired[(size_t) index]->decReferenceCount();
+        retired[(size_t) index] = nullptr;
+    });
+}
+
+const ArpPattern* PatternHandoff::acquire() noexcept
+{
+    auto* incoming = pending.exchange (nullptr, std::memory_order_acq_rel);
+    if (incoming == nullptr)
+        return nullptr;
+
+    if (live != nullptr)
+    {
+        // At most two patterns can be retired between two submissions, so
+        // the FIFO never fills up.
+        const auto scope = retiredFifo.write (1);
+        jassert (scope.blockSize1 + scope.blockSize2 == 1);
+        scope.forEach ([this] (int index) { retired[(size_t) index] = live; });
+    }
+
+    live = incoming;
+    return live;
+}
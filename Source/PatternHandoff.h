@@ -0,0 +1,53 @@
+/*
+  ==============================================================================
+
+    PatternHandoff.h
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ArpPattern.h"
+
+//==============================================================================
+/**
+    Hands compiled patterns from the message thread to the audio thread.
+
+    The message thread submits a pattern through an atomic pointer. The audio
+    thread picks it up at the start of a block and puts the pattern it was
+    playing on a lock-free FIFO, so that the message thread, not the audio
+    thread, drops the last reference and frees it.
+*/
+class PatternHandoff
+{
+public:
+    PatternHandoff() = default;
+    ~PatternHandoff();
+
+    /** Message thread: queues a pattern, replacing any pattern that the audio
+        thread has not picked up yet. */
+    void submit (ArpPattern::Ptr pattern);
+
+    /** Message thread: releases the patterns the audio thread has retired. */
+    void releaseRetired();
+
+    /** Audio thread: returns the pattern submitted since the last call, or
+        nullptr if there is none. The returned pattern stays valid until the
+        next pattern is acquired. */
+    const ArpPattern* acquire() noexcept;
+
+private:
+    static constexpr int retiredCapacity = 8;
+
+    std::atomic<ArpPattern*> pending { nullptr };
+    ArpPattern* live = nullptr;
+
+    juce::AbstractFifo retiredFifo { retiredCapacity };
+    std::array<ArpPattern*, retiredCapacity> retired {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PatternHandoff)
+};
@@ -8,6 +8,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "PatternGenerator.h"
 
 //==============================================================================
 void TeArAudioProcessorEditor::ArpLookAndFeel::fillTextEditorBackground (juce::Graphics& g, int width, int height, juce::TextEditor& editor)
@@ -78,15 +79,15 @@ TeArAudioProcessorEditor::TeArAudioProcessorEditor (TeArAudioProcessor& p)
 {
     audioProcessor.addChangeListener(this);
 
-    lastStepIndices.insertMultiple(0, -1, 4);
+    lastStepIndices.insertMultiple(0, -1, audioProcessor.getNumArpeggiators());
 
     auto& apvts = audioProcessor.getAPVTS();
 
     const auto neutralColour = juce::Colours::white;
 
-    for (int i = 0; i < 4; ++i)
+    for (int i = 0; i < audioProcessor.getNumArpeggiators(); ++i)
     {
-        juce::Colour arpColour = arpColours[i];
+        juce::Colour arpColour = ScaleComponent::getColourForArp(i);
         auto* editor = new ArpeggiatorTextEditor();
         arpeggiatorEditors.add(editor);
         addAndMakeVisible(editor);
@@ -140,9 +141,9 @@ TeArAudioProcessorEditor::TeArAudioProcessorEditor (TeArAudioProcessor& p)
     chordMethodBox.onChange = [this] { updateScaleDisplay(); };
 
     // --- Per-Arpeggiator Controls (Individual Colors) ---
-    for (int i = 0; i < 4; ++i)
+    for (int i = 0; i < audioProcessor.getNumArpeggiators(); ++i)
     {
-        juce::Colour arpColour = arpColours[i];
+        juce::Colour arpColour = ScaleComponent::getColourForArp(i);
         auto* label = new juce::Label();
         // subdivisionLabels.add(label);
         // addAndMakeVisible(label);
@@ -168,9 +169,9 @@ TeArAudioProcessorEditor::TeArAudioProcessorEditor (TeArAudioProcessor& p)
         subdivisionAttachments.add(std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, paramID, *box));
     }
     
-    for (int i = 0; i < 4; ++i)
+    for (int i = 0; i < audioProcessor.getNumArpeggiators(); ++i)
     {
-        juce::Colour arpColour = arpColours[i];
+        juce::Colour arpColour = ScaleComponent::getColourForArp(i);
         auto* button = new juce::ToggleButton();
         arpeggiatorOnButtons.add(button);
         addAndMakeVisible(button);
@@ -192,30 +193,31 @@ TeArAudioProcessorEditor::TeArAudioProcessorEditor (TeArAudioProcessor& p)
         rndButton->setColour(juce::TextButton::textColourOffId, arpColour);
         rndButton->setColour(juce::TextButton::textColourOnId, arpColour.brighter());
         rndButton->onClick = [this, i, rndButton, arpColour] {
-            auto& arp = audioProcessor.getArpeggiator(i);
-            
-            auto makeEuclidian = [&arp](int hits, int steps, int rotation) {
-                // We need to cast away constness because makeEuclidianPattern is not const in Arpeggiator
-                // or we should make it const. Assuming we can call it:
-                return const_cast<Arpeggiator&>(arp).makeEuclidianPattern(hits, steps, rotation);
+            // The generators don't touch the arpeggiator the audio thread is playing.
+            auto makeEuclidian = [](int hits, int steps, int rotation) {
+                return PatternGenerator::makeEuclidianPattern(hits, steps, rotation);
             };
-            
-            auto makeRandom = [&arp]() {
-                return const_cast<Arpeggiator&>(arp).makeRandomPattern();
+
+            auto getEuclidianRotations = [](int hits, int steps) {
+                return PatternGenerator::getEuclideanRotations(hits, steps);
+            };
+
+            auto makeRandom = [this, i]() {
+                return PatternGenerator::makeRandomPattern(audioProcessor.getNextPatternSeed(i));
             };
             
             auto onOk = [this, i](juce::String pattern) {
                 audioProcessor.setArpeggiatorPattern(i, pattern);
             };
 
-            auto* content = new ArpPatternPopup(makeEuclidian, makeRandom, onOk, arpColour);
+            auto* content = new ArpPatternPopup(makeEuclidian, getEuclidianRotations, makeRandom, onOk, arpColour);
             juce::CallOutBox::launchAsynchronously(std::unique_ptr<juce::Component>(content), rndButton->getScreenBounds(), this);
         };
     }
 
-    for (int i = 0; i < 4; ++i)
+    for (int i = 0; i < audioProcessor.getNumArpeggiators(); ++i)
     {
-        juce::Colour arpColour = arpColours[i];
+        juce::Colour arpColour = ScaleComponent::getColourForArp(i);
 
         auto* label = new juce::Label();
         midiChannelLabels.add(label);
@@ -236,6 +238,43 @@ TeArAudioProcessorEditor::TeArAudioProcessorEditor (TeArAudioProcessor& p)
         midiChannelAttachments.add(std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, "midiChannel" + juce::String(i + 1), *box));
     }
 
+    for (int i = 0; i < audioProcessor.getNumArpeggiators(); ++i)
+    {
+        juce::Colour arpColour = ScaleComponent::getColourForArp(i);
+
+        // Small knobs, which show their value while they are dragged.
+        auto makeKnob = [this, arpColour](const juce::String& name) {
+            auto* knob = new juce::Slider(name);
+            addAndMakeVisible(knob);
+            knob->setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
+            knob->setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+            knob->setTextValueSuffix("% " + name);
+            knob->setPopupDisplayEnabled(true, true, this);
+            knob->setColour(juce::Slider::rotarySliderFillColourId, arpColour);
+            knob->setColour(juce::Slider::rotarySliderOutlineColourId, arpColour.withAlpha(0.3f));
+            knob->setColour(juce::Slider::thumbColourId, arpColour.brighter());
+            return knob;
+        };
+
+        auto* gateKnob = gateKnobs.add(makeKnob("gate"));
+        gateAttachments.add(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, "gate" + juce::String(i + 1), *gateKnob));
+
+        auto* swingKnob = swingKnobs.add(makeKnob("swing"));
+        swingAttachments.add(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, "swing" + juce::String(i + 1), *swingKnob));
+
+        auto* voicingBox = voicingBoxes.add(new juce::ComboBox("voicing"));
+        addAndMakeVisible(voicingBox);
+        voicingBox->setLookAndFeel(&arpLookAndFeel);
+        voicingBox->setColour(juce::ComboBox::textColourId, arpColour);
+        voicingBox->setColour(juce::ComboBox::outlineColourId, arpColour);
+        voicingBox->setColour(juce::ComboBox::backgroundColourId, juce::Colours::transparentBlack);
+
+        auto paramID = "voicing" + juce::String(i + 1);
+        if (auto* parameter = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(paramID)))
+            voicingBox->addItemList(parameter->choices, 1);
+        voicingAttachments.add(std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, paramID, *voicingBox));
+    }
+
     addAndMakeVisible(scaleRootLabel);
     scaleRootLabel.setText("Scale Root", juce::dontSendNotification);
     scaleRootLabel.attachToComponent(&scaleRootBox, true);
@@ -281,6 +320,12 @@ TeArAudioProcessorEditor::TeArAudioProcessorEditor (TeArAudioProcessor& p)
     followMidiInButton.setColour(juce::ToggleButton::textColourId, neutralColour);
     followMidiInAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(apvts, "followMidiIn", followMidiInButton);
 
+    // Whether the followed root is written to the host, which records it if its automation is armed
+    addAndMakeVisible(followMidiInAutomationButton);
+    followMidiInAutomationButton.setButtonText("Rec");
+    followMidiInAutomationButton.setColour(juce::ToggleButton::textColourId, neutralColour);
+    followMidiInAutomationAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(apvts, "followMidiInAutomation", followMidiInAutomationButton);
+
     addAndMakeVisible(scaleComponent);
     addAndMakeVisible(logo);
 
@@ -291,7 +336,8 @@ TeArAudioProcessorEditor::TeArAudioProcessorEditor (TeArAudioProcessor& p)
     updateScaleDisplay();
 
 
-    setSize (960, 400); // Increased size for multiple arps
+    // The lanes are laid out in rows of four, each row adds room for its editors.
+    setSize (960, 400 + (getNumLaneRows() - 1) * laneRowHeight);
 }
 
 TeArAudioProcessorEditor::~TeArAudioProcessorEditor()
@@ -302,6 +348,7 @@ TeArAudioProcessorEditor::~TeArAudioProcessorEditor()
     for (auto* box : midiChannelBoxes) box->setLookAndFeel(nullptr);
     for (auto* label : subdivisionLabels) label->setLookAndFeel(nullptr);
     for (auto* box : subdivisionBoxes) box->setLookAndFeel(nullptr);
+    for (auto* box : voicingBoxes) box->setLookAndFeel(nullptr);
     audioProcessor.removeChangeListener(this);
     stopTimer();
 }
@@ -315,34 +362,32 @@ void TeArAudioProcessorEditor::changeListenerCallback (juce::ChangeBroadcaster*
 
 void TeArAudioProcessorEditor::timerCallback()
 {
-    const bool notesAreHeld = audioProcessor.areNotesHeld();
+    // Everything shown here comes from the snapshot the audio thread published
+    // at the end of its last block, never from the arpeggiators themselves.
+    const auto& telemetry = audioProcessor.getTelemetry();
+    const bool notesAreHeld = telemetry.notesHeld;
+
+    auto isLaneOn = [&telemetry](int i) { return ((telemetry.activeLanes >> i) & 1) != 0; };
 
     if (notesAreHeld)
     {
-        // The chord is the same for all arps, so we can get it from the first one.
-        const auto& chord = audioProcessor.getArpeggiator(0).getChord();
-        auto chordMethod = static_cast<int>(audioProcessor.getAPVTS().getRawParameterValue("chordMethod")->load());
-        const auto& notes = (chordMethod == 1) ? chord.getRawNotes() : chord.getDegrees();
-
-        // Collect all currently playing notes from active arpeggiators
-        juce::Array<juce::var> currentNotes;
-        for (int i = 0; i < 4; ++i)
+        if (telemetry.chordRoot != -1)
         {
-            if (audioProcessor.isArpeggiatorOn(i))
+            ScaleComponent::NoteState noteState;
+            noteState.scalePitchClasses = telemetry.chordPitchClasses;
+            noteState.rootPitchClass = telemetry.chordRoot;
+
+            // Collect all currently playing notes from active arpeggiators
+            for (int i = 0; i < audioProcessor.getNumArpeggiators(); ++i)
             {
-                int note = audioProcessor.getArpeggiator(i).getLastPlayedNote();
-                if (note != -1)
-                {
-                    auto* noteInfo = new juce::DynamicObject();
-                    noteInfo->setProperty("note", note);
-                    noteInfo->setProperty("arpIndex", i);
-                    currentNotes.add(juce::var(noteInfo));
-                }
+                int note = telemetry.lastNote[(size_t) i];
+                if (isLaneOn(i) && note != -1)
+                    noteState.lanePitchClasses[(size_t) i] = (juce::uint16) (1 << (note % 12));
             }
-        }
 
-        if (!notes.isEmpty())
-            scaleComponent.updateScale(notes, notes.getFirst(), currentNotes);
+            // Repaints nothing if the display did not change since the last tick.
+            scaleComponent.setNoteState(noteState);
+        }
     }
     else
     {
@@ -352,30 +397,25 @@ void TeArAudioProcessorEditor::timerCallback()
     // Update step highlights for each editor
     if (notesAreHeld) // Only highlight if notes are held
     {
-        for (int i = 0; i < 4; ++i)
+        for (int i = 0; i < audioProcessor.getNumArpeggiators(); ++i)
         {
             auto* editor = arpeggiatorEditors[i];
 
-            if (!editor->hasKeyboardFocus(true) && audioProcessor.isArpeggiatorOn(i))
+            if (!editor->hasKeyboardFocus(true) && isLaneOn(i))
             {
-                int currentStep = audioProcessor.getArpeggiatorCurrentStep(i);
+                int currentStep = telemetry.currentStep[(size_t) i];
 
                 if (currentStep != lastStepIndices[i])
                 {
                     lastStepIndices.set(i, currentStep);
 
-                    const auto& arp = audioProcessor.getArpeggiator(i);
-                    const auto& pattern = audioProcessor.getArpeggiatorPattern(i);
-                    int stepStart = arp.getPatternIndexForStep(currentStep);
-                    int stepEnd = arp.getPatternIndexForStep(currentStep + 1);
-
-                    if (stepEnd <= stepStart)
-                        stepEnd = pattern.length();
-
-                    editor->setHighlightedRegion({ stepStart, stepEnd });
+                    // From the step to the next one, or to the end of the text for the last step.
+                    const auto* compiled = audioProcessor.getCompiledArpeggiatorPattern(i);
+                    editor->setHighlightedRegion(compiled != nullptr ? compiled->getSourceRangeForStep(currentStep)
+                                                                     : juce::Range<int>(0, audioProcessor.getArpeggiatorPattern(i).length()));
                 }
             }
-            else if (lastStepIndices[i] != -1 || !audioProcessor.isArpeggiatorOn(i)) // Clear highlight if not on or not playing
+            else if (lastStepIndices[i] != -1 || !isLaneOn(i)) // Clear highlight if not on or not playing
             {
                 editor->setHighlightedRegion({});
                 lastStepIndices.set(i, -1);
@@ -384,7 +424,7 @@ void TeArAudioProcessorEditor::timerCallback()
     }
     else // If no notes are held, clear all highlights
     {
-        for (int i = 0; i < 4; ++i)
+        for (int i = 0; i < audioProcessor.getNumArpeggiators(); ++i)
         {
             if (lastStepIndices[i] != -1)
             {
@@ -393,6 +433,14 @@ void TeArAudioProcessorEditor::timerCallback()
             }
         }
     }
+
+    // Without Rec, the followed root never reaches the Scale Root parameter,
+    // so the label says which root the lanes follow instead.
+    const auto followedRoot = audioProcessor.getFollowedRoot();
+    if (followedRoot >= 0 && followedRoot != scaleRootBox.getSelectedItemIndex())
+        scaleRootLabel.setText("Following " + scaleRootBox.getItemText(followedRoot), juce::dontSendNotification);
+    else
+        scaleRootLabel.setText("Scale Root", juce::dontSendNotification);
 }
 
 void TeArAudioProcessorEditor::updateScaleDisplay()
@@ -401,21 +449,35 @@ void TeArAudioProcessorEditor::updateScaleDisplay()
     auto chordMethod = static_cast<int>(apvts.getRawParameterValue("chordMethod")->load());
 
     // When not playing, only show the scale if the method is "Single note".
+    ScaleComponent::NoteState noteState;
     if (chordMethod == 2) // "Single note"
     {
-        auto scaleRoot = static_cast<int>(apvts.getRawParameterValue("scaleRoot")->load());
-        auto scaleType = static_cast<MidiTools::Scale::Type>(static_cast<int>(apvts.getRawParameterValue("scaleType")->load()));
+        // The root followed from the MIDI input may not have reached the parameter.
+        auto scaleRoot = audioProcessor.getFollowedRoot();
+        if (scaleRoot < 0)
+            scaleRoot = static_cast<int>(apvts.getRawParameterValue("scaleRoot")->load());
+        auto scaleType = static_cast<int>(apvts.getRawParameterValue("scaleType")->load());
+
+        // This runs on every timer tick while no key is held, so the scale is
+        // only rebuilt when it changed.
+        if (scaleRoot != displayedScaleRoot || scaleType != displayedScaleType)
+        {
+            currentDisplayScale = MidiTools::Scale(scaleRoot, static_cast<MidiTools::Scale::Type>(scaleType));
+            displayedScaleRoot = scaleRoot;
+            displayedScaleType = scaleType;
 
-        currentDisplayScale = MidiTools::Scale(scaleRoot, scaleType);
+            displayedScalePitchClasses = 0;
+            for (auto note : currentDisplayScale.getNotes())
+                displayedScalePitchClasses |= (juce::uint16) (1 << (note % 12));
+        }
 
-        // Update the component with the scale notes, but with -1 for root and current note
-        // to indicate that no note is currently playing. The root note should be shown.
-        scaleComponent.updateScale(currentDisplayScale.getNotes(), currentDisplayScale.getRootNote(), {});
+        // Show the scale and its root, with no note playing.
+        noteState.scalePitchClasses = displayedScalePitchClasses;
+        noteState.rootPitchClass = currentDisplayScale.getRootNote() % 12;
     }
-    else // For "Notes played" or "Chord played as is", clear the display when not playing.
-        scaleComponent.updateScale({}, -1, {});
+    // For "Notes played" or "Chord played as is", clear the display when not playing.
 
-    lastPlayedArpNote = -1; // Reset the last played note tracker
+    scaleComponent.setNoteState(noteState);
 }
 //==============================================================================
 void TeArAudioProcessorEditor::paint (juce::Graphics& g)
@@ -435,34 +497,40 @@ void TeArAudioProcessorEditor::resized()
 {
     auto bounds = getLocalBounds().reduced(10);
 
-    juce::FlexBox mainBox, editorBox, controlsBox, subdivisionRowBox, channelRowBox;
+    juce::FlexBox mainBox, controlsBox;
     mainBox.flexDirection = juce::FlexBox::Direction::column;
-    editorBox.flexDirection = juce::FlexBox::Direction::row;
     controlsBox.flexDirection = juce::FlexBox::Direction::row;
-    subdivisionRowBox.flexDirection = juce::FlexBox::Direction::row;
-    channelRowBox.flexDirection = juce::FlexBox::Direction::row;
 
-    for (int i = 0; i < 4; ++i)
+    // Lanes are laid out in rows of four: the editors, then the lane controls below them.
+    juce::Array<juce::FlexBox> editorRows, controlRows;
+    editorRows.resize(getNumLaneRows());
+    controlRows.resize(getNumLaneRows());
+    for (int row = 0; row < getNumLaneRows(); ++row)
     {
-        int leftMargin = 5;
-        int rightMargin = 5;
-        if (i==0) leftMargin = 0;
-        if (i==3) rightMargin = 0;
-        editorBox.items.add(juce::FlexItem(*arpeggiatorEditors[i]).withFlex(1.0f).withMargin(juce::FlexItem::Margin(0, rightMargin, 0, leftMargin)));
+        editorRows.getReference(row).flexDirection = juce::FlexBox::Direction::row;
+        controlRows.getReference(row).flexDirection = juce::FlexBox::Direction::row;
     }
 
-    for (int i = 0; i < 4; ++i)
+    const int numArpeggiators = audioProcessor.getNumArpeggiators();
+    for (int i = 0; i < numArpeggiators; ++i)
     {
+        auto& editorBox = editorRows.getReference(i / lanesPerRow);
+        auto& subdivisionRowBox = controlRows.getReference(i / lanesPerRow);
+
         int leftMargin = 5;
         int rightMargin = 5;
-        if (i == 0) leftMargin = 0;
-        if (i == 3) rightMargin = 0;
+        if (i % lanesPerRow == 0) leftMargin = 0;
+        if (i % lanesPerRow == lanesPerRow - 1 || i == numArpeggiators - 1) rightMargin = 0;
+        editorBox.items.add(juce::FlexItem(*arpeggiatorEditors[i]).withFlex(1.0f).withMargin(juce::FlexItem::Margin(0, rightMargin, 0, leftMargin)));
 
         // Add the On/Off button to the left of the subdivision label
         subdivisionRowBox.items.add(juce::FlexItem(*arpeggiatorOnButtons[i]).withFlex(0.15f).withMargin(juce::FlexItem::Margin(0.f, 2.f, 0.f, (float)leftMargin)));
         subdivisionRowBox.items.add(juce::FlexItem(*randomizeButtons[i]).withFlex(0.15f).withMargin(juce::FlexItem::Margin(0.f, 2.f, 0.f, 0.f)));
         //subdivisionRowBox.items.add(juce::FlexItem(*subdivisionLabels[i]).withFlex(0.25f));
         subdivisionRowBox.items.add(juce::FlexItem(*subdivisionBoxes[i]).withFlex(0.5f).withMargin(juce::FlexItem::Margin(0.f, 2.f, 0.f, 0.f)));
+        subdivisionRowBox.items.add(juce::FlexItem(*gateKnobs[i]).withFlex(0.15f).withMargin(juce::FlexItem::Margin(0.f, 2.f, 0.f, 0.f)));
+        subdivisionRowBox.items.add(juce::FlexItem(*swingKnobs[i]).withFlex(0.15f).withMargin(juce::FlexItem::Margin(0.f, 2.f, 0.f, 0.f)));
+        subdivisionRowBox.items.add(juce::FlexItem(*voicingBoxes[i]).withFlex(0.5f).withMargin(juce::FlexItem::Margin(0.f, 2.f, 0.f, 0.f)));
         subdivisionRowBox.items.add(juce::FlexItem(*midiChannelLabels[i]).withFlex(0.18f).withMargin(juce::FlexItem::Margin(0.f, 0.f, 0.f, 0.f)));
         subdivisionRowBox.items.add(juce::FlexItem(*midiChannelBoxes[i]).withFlex(0.4f).withMargin(juce::FlexItem::Margin(0.f, (float)rightMargin, 0.f, 0.f)));
     }
@@ -472,13 +540,22 @@ void TeArAudioProcessorEditor::resized()
     controlsBox.items.add(juce::FlexItem(chordMethodBox).withFlex(1.0f));
     controlsBox.items.add(juce::FlexItem(scaleRootLabel).withFlex(0.5f).withMargin(juce::FlexItem::Margin(0.f, 0.f, 0.f, 10.f)));
     controlsBox.items.add(juce::FlexItem(scaleRootBox).withFlex(0.5f));
-    controlsBox.items.add(juce::FlexItem(followMidiInButton).withFlex(0.6f).withMargin(juce::FlexItem::Margin(0.f, 5.f, 0.f, 5.f)));
+    controlsBox.items.add(juce::FlexItem(followMidiInButton).withFlex(0.6f).withMargin(juce::FlexItem::Margin(0.f, 0.f, 0.f, 5.f)));
+    controlsBox.items.add(juce::FlexItem(followMidiInAutomationButton).withFlex(0.3f).withMargin(juce::FlexItem::Margin(0.f, 5.f, 0.f, 0.f)));
     controlsBox.items.add(juce::FlexItem(scaleTypeLabel).withFlex(0.5f));
     controlsBox.items.add(juce::FlexItem(scaleTypeBox).withFlex(1.0f));
 
     mainBox.items.add(juce::FlexItem(controlsBox).withFlex(0.12f).withMargin(juce::FlexItem::Margin(0.f, 10.f, 0.f, 10.f)));
     mainBox.items.add(juce::FlexItem(scaleComponent).withFlex(0.17f).withMargin(juce::FlexItem::Margin(5.f, 10.f, 0.f, 10.f)));
-    mainBox.items.add(juce::FlexItem(editorBox).withFlex(1.0f).withMargin(10));
-    mainBox.items.add(juce::FlexItem(subdivisionRowBox).withFlex(0.12f).withMargin(juce::FlexItem::Margin(0.f, 10.f, 0.f, 10.f)));
+    for (int row = 0; row < getNumLaneRows(); ++row)
+    {
+        mainBox.items.add(juce::FlexItem(editorRows.getReference(row)).withFlex(1.0f).withMargin(10));
+        mainBox.items.add(juce::FlexItem(controlRows.getReference(row)).withFlex(0.12f).withMargin(juce::FlexItem::Margin(0.f, 10.f, 0.f, 10.f)));
+    }
     mainBox.performLayout(bounds);
 }
+
+int TeArAudioProcessorEditor::getNumLaneRows() const
+{
+    return (audioProcessor.getNumArpeggiators() + lanesPerRow - 1) / lanesPerRow;
+}
@@ -100,6 +100,15 @@ private:
     juce::Array<juce::ComboBox*> subdivisionBoxes;
     juce::Array<std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment>> subdivisionAttachments;
 
+    // Gate and swing knobs, one of each per arpeggiator
+    juce::OwnedArray<juce::Slider> gateKnobs;
+    juce::OwnedArray<juce::Slider> swingKnobs;
+    juce::Array<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>> gateAttachments;
+    juce::Array<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>> swingAttachments;
+
+    juce::OwnedArray<juce::ComboBox> voicingBoxes;
+    juce::Array<std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment>> voicingAttachments;
+
     juce::Array<juce::Label*> midiChannelLabels;
     juce::Array<juce::ComboBox*> midiChannelBoxes;
     juce::Array<std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment>> midiChannelAttachments;
@@ -114,21 +123,23 @@ private:
 
     juce::ToggleButton followMidiInButton;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> followMidiInAttachment;
+    juce::ToggleButton followMidiInAutomationButton;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> followMidiInAutomationAttachment;
 
     ScaleComponent scaleComponent;
-    int lastPlayedArpNote = -1;
     MidiTools::Scale currentDisplayScale {0, MidiTools::Scale::Type::Major};
+    int displayedScaleRoot = -1;
+    int displayedScaleType = -1;
+    juce::uint16 displayedScalePitchClasses = 0;
     
     juce::Array<int> lastStepIndices;
 
     FxmeLogo logo{"",false};
 
-    const juce::Colour arpColours[4] {
-        juce::Colours::lime,
-        juce::Colours::cyan,
-        juce::Colours::magenta,
-        juce::Colours::yellow
-    };
+    // Lanes are laid out in rows, each row adds this much to the editor's height
+    static constexpr int lanesPerRow = 4;
+    static constexpr int laneRowHeight = 240;
+    int getNumLaneRows() const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TeArAudioProcessorEditor)
 };
@@ -8,10 +8,13 @@
  
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "PatternGenerator.h"
+#include "LaneMerger.h"
+#include "PatternCache.h"
 //#include <memory>
 
 //==============================================================================
-TeArAudioProcessor::TeArAudioProcessor()
+TeArAudioProcessor::TeArAudioProcessor (int numArpeggiatorsToUse)
 #ifndef JucePlugin_PreferredChannelConfigurations
      : AudioProcessor (BusesProperties()
                      #if ! JucePlugin_IsMidiEffect
@@ -22,46 +25,81 @@ TeArAudioProcessor::TeArAudioProcessor()
                      #endif
                        )
      #endif
+    , numArpeggiators(juce::jlimit(1, maxNumArpeggiators, numArpeggiatorsToUse))
     , apvts(*this, nullptr, "Parameters", createParameters())
+    , scaleTable(ScaleTable::getInstance()) // Built here, so the audio thread never builds it
 {
-    for (int i = 0; i < 4; ++i)
+    for (int i = 0; i < numArpeggiators; ++i)
     {
-        arpeggiators.add(Arpeggiator());
-        arpeggiatorOnStates.add(true); // Default to ON
-        arpeggiatorMidiChannels.add(i + 1); // Default to channel i + 1
-        apvts.addParameterListener("midiChannel" + juce::String(i + 1), this);
-        apvts.addParameterListener("arpOn" + juce::String(i + 1), this);
-        arpeggiatorPatterns.add("1 2 3");
-        apvts.addParameterListener("subdivision" + juce::String(i + 1), this);
+        setLaneOn(i, true); // Default to ON
+        arpeggiatorMidiChannels[(size_t) i] = i + 1; // Default to channel i + 1
+        arpeggiatorPatterns.add(defaultPattern);
+        compiledPatterns.add(PatternCache::getInstance()->getPattern(arpeggiatorPatterns[i]));
+        patternHandoffs.add(new PatternHandoff())->submit(compiledPatterns[i]);
     }
 
-    apvts.addParameterListener("chordMethod", this);
-    apvts.addParameterListener("scaleRoot", this);
-    apvts.addParameterListener("scaleType", this);
-    apvts.addParameterListener("followMidiIn", this);
+    // Resolve the parameters once, so neither the audio thread nor the
+    // listener callback has to look them up by name.
+    auto addParameter = [this](const juce::String& parameterID, ParameterKind kind, int arpIndex) -> std::atomic<float>*
+    {
+        parameterTargets.set(parameterID, { kind, arpIndex });
+        apvts.addParameterListener(parameterID, this);
+        return apvts.getRawParameterValue(parameterID);
+    };
+
+    for (int i = 0; i < numArpeggiators; ++i)
+    {
+        parameters.arpOn.add(addParameter("arpOn" + juce::String(i + 1), ParameterKind::arpOn, i));
+        parameters.midiChannel.add(addParameter("midiChannel" + juce::String(i + 1), ParameterKind::midiChannel, i));
+        parameters.subdivision.add(addParameter("subdivision" + juce::String(i + 1), ParameterKind::subdivision, i));
+        parameters.gate.add(addParameter("gate" + juce::String(i + 1), ParameterKind::gate, i));
+        parameters.swing.add(addParameter("swing" + juce::String(i + 1), ParameterKind::swing, i));
+        parameters.voicing.add(addParameter("voicing" + juce::String(i + 1), ParameterKind::voicing, i));
+    }
+
+    parameters.chordMethod = addParameter("chordMethod", ParameterKind::chordMethod, -1);
+    parameters.scaleRoot = addParameter("scaleRoot", ParameterKind::scaleRoot, -1);
+    parameters.scaleType = addParameter("scaleType", ParameterKind::scaleType, -1);
+    parameters.followMidiIn = addParameter("followMidiIn", ParameterKind::followMidiIn, -1);
+    parameters.followMidiInAutomation = addParameter("followMidiInAutomation", ParameterKind::followMidiInAutomation, -1);
+    parameters.scaleRootParameter = apvts.getParameter("scaleRoot");
+
+    for (auto* parameterID : { "chordMethod", "scaleRoot", "scaleType", "followMidiIn", "followMidiInAutomation" })
+        parameters.globalParameters.add(apvts.getParameter(parameterID));
+
+    for (int i = 0; i < numArpeggiators; ++i)
+        for (auto* parameterID : { "arpOn", "midiChannel", "subdivision", "gate", "swing", "voicing" })
+            parameters.laneParameters.add(apvts.getParameter(parameterID + juce::String(i + 1)));
+
+    parameters.numParametersPerLane = parameters.laneParameters.size() / numArpeggiators;
 
     // Initialize arpeggiators with the current parameter values
-    int currentChordMethod = static_cast<int>(apvts.getRawParameterValue("chordMethod")->load());
-    for (int i = 0; i < 4; ++i)
+    int currentChordMethod = static_cast<int>(parameters.chordMethod->load());
+    for (int i = 0; i < numArpeggiators; ++i)
     {
-        arpeggiators.getReference(i).setChordMethod(currentChordMethod);
-        if (auto* p = apvts.getRawParameterValue("subdivision" + juce::String(i + 1)))
-            arpeggiators.getReference(i).setSubdivision(static_cast<int>(p->load()));
+        arpeggiators[(size_t) i].setChordMethod(currentChordMethod);
+        arpeggiators[(size_t) i].setSubdivision(static_cast<int>(parameters.subdivision[i]->load()));
+        arpeggiators[(size_t) i].setGate(static_cast<int>(parameters.gate[i]->load()));
+        arpeggiators[(size_t) i].setSwing(static_cast<int>(parameters.swing[i]->load()));
+        arpeggiators[(size_t) i].setVoicing(static_cast<ArpEngine::Voicing>(static_cast<int>(parameters.voicing[i]->load())));
     }
+
+    // Each new instance gets its own seed, kept with its state from then on.
+    setRandomSeed(juce::Random::getSystemRandom().nextInt64());
+    laneRandomSeed = getRandomSeed();
+    for (int i = 0; i < numArpeggiators; ++i)
+        arpeggiators[(size_t) i].setRandomSeed((juce::uint64) laneRandomSeed, i);
+
+    // Drains the followed roots queued by the audio thread
+    startTimerHz(30);
 }
 
 TeArAudioProcessor::~TeArAudioProcessor()
 {
-    for (int i = 0; i < 4; ++i)
-        apvts.removeParameterListener("midiChannel" + juce::String(i + 1), this);
-    for (int i = 0; i < 4; ++i)
-        apvts.removeParameterListener("arpOn" + juce::String(i + 1), this);
-    for (int i = 0; i < 4; ++i)
-        apvts.removeParameterListener("subdivision" + juce::String(i + 1), this);
-    apvts.removeParameterListener("chordMethod", this);
-    apvts.removeParameterListener("scaleRoot", this);
-    apvts.removeParameterListener("scaleType", this);
-    apvts.removeParameterListener("followMidiIn", this);
+    stopTimer();
+
+    for (decltype(parameterTargets)::Iterator target(parameterTargets); target.next();)
+        apvts.removeParameterListener(target.getKey(), this);
 }
 
 //==============================================================================
@@ -129,10 +167,29 @@ void TeArAudioProcessor::changeProgramName (int index, const juce::String& newNa
 //==============================================================================
 void TeArAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    for (int i = 0; i < arpeggiators.size(); ++i)
+    // Patterns are compiled when they are set, and picked up by processBlock.
+    transport.prepare(sampleRate);
+
+    // Reserve room for the block's input notes and output events, so that
+    // processBlock does not allocate. Even at 1/64T a lane plays far less
+    // than a note every 16 samples, and each note is a note-on and a note-off.
+    inputNotes.ensureStorageAllocated(256);
+    laneCommands.ensureStorageAllocated(3 * 256 + 4);
+    const int maxEventsPerLane = 2 * (samplesPerBlock / 16 + 4);
+    outputBufferSize = (size_t) (numArpeggiators * maxEventsPerLane) * 16;
+    for (int i = 0; i < numArpeggiators; ++i)
+        laneBuffers[(size_t) i].ensureSize((size_t) maxEventsPerLane * 16);
+
+    // With enough lanes, leave a core to the host and share the rest between the lanes.
+    const int numWorkers = juce::jmin(3, juce::SystemStats::getNumCpus() - 1, numArpeggiators / 4);
+    if (useWorkerThreads && numArpeggiators >= parallelLaneThreshold && numWorkers > 0)
     {
-        arpeggiators.getReference(i).prepareToPlay(sampleRate);
-        arpeggiators.getReference(i).setPattern(arpeggiatorPatterns[i]);
+        if (workerPool == nullptr || workerPool->getNumWorkers() != numWorkers)
+            workerPool = std::make_unique<LaneWorkerPool>(numWorkers);
+    }
+    else
+    {
+        workerPool.reset();
     }
 }
 
@@ -140,6 +197,12 @@ void TeArAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    workerPool.reset();
+}
+
+void TeArAudioProcessor::setUseWorkerThreads(bool shouldUseWorkerThreads)
+{
+    useWorkerThreads = shouldUseWorkerThreads;
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -174,174 +237,279 @@ void TeArAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::M
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
-    bool transportJustStopped = false;
+    // --- Take the lanes that are on for the whole block ---
+    numBlockLanes = 0;
+    for (auto mask = activeLanes.load(std::memory_order_relaxed); mask != 0; mask &= mask - 1)
+        blockLanes[(size_t) numBlockLanes++] = juce::countNumberOfBits((mask & (~mask + 1)) - 1);
 
-    // --- Get Host Transport Information ---
-    if (auto* playHead = getPlayHead())
+    // --- Pick up the seed, if it was set from the message thread ---
+    if (const auto seed = randomSeed.load(std::memory_order_relaxed); seed != laneRandomSeed)
     {
-        juce::AudioPlayHead::CurrentPositionInfo positionInfo;
-        if (playHead->getCurrentPosition(positionInfo))
-        {
-            // Update tempo if it has changed
-            if (positionInfo.bpm > 0.0 && positionInfo.bpm != lastKnownBPM)
-            {
-                lastKnownBPM = positionInfo.bpm;
-                for (auto& arp : arpeggiators) arp.setTempo(lastKnownBPM);
-            }
+        laneRandomSeed = seed;
+        for (int i = 0; i < numArpeggiators; ++i)
+            arpeggiators[(size_t) i].setRandomSeed((juce::uint64) seed, i);
+    }
 
-            // Sync the arpeggiator to the host's grid if playing
-            // Only sync arpeggiators that are turned on
-            if (positionInfo.isPlaying)
-                for (auto& arp : arpeggiators) arp.syncToPlayHead(positionInfo);
-            else if (wasPlaying)
-                transportJustStopped = true;
+    // --- Pick up the patterns compiled on the message thread ---
+    for (int i = 0; i < numArpeggiators; ++i)
+        if (auto* pattern = patternHandoffs.getUnchecked(i)->acquire())
+            arpeggiators[(size_t) i].setPattern(pattern);
 
-            if (positionInfo.isPlaying && !wasPlaying) // Playback just started
-            {
-                // This block can be used for logic that needs to run only on the first block of playback.
-            }
-            wasPlaying = positionInfo.isPlaying;
-        }
-    }
+    const int numSamples = buffer.getNumSamples();
 
-    // --- Handle incoming MIDI notes to track held notes ---
-    bool notesChanged = false;
+    // --- Follow the host's transport ---
+    // All the lanes play on the ticks of the one clock: the host's position
+    // while it plays, the last tempo while it is stopped.
+    transport.update(getPlayHead(), numSamples);
+    const bool transportJustStopped = transport.hasStopped();
+
+    // --- Copy the incoming notes out, so the host buffer can take our output ---
+    inputNotes.clearQuick();
     for (const auto metadata : midiMessages) // This is why we must not clear midiMessages at the start!
     {
         const auto msg = metadata.getMessage();
         if (msg.isNoteOn())
+            inputNotes.add({ metadata.samplePosition, msg.getNoteNumber(), msg.getVelocity(), true });
+        else if (msg.isNoteOff())
+            inputNotes.add({ metadata.samplePosition, msg.getNoteNumber(), 0, false });
+    }
+
+    // --- Record what the lanes have to do in this block ---
+    laneCommands.clearQuick();
+
+    // If the transport just stopped, send a note off.
+    if (transportJustStopped)
+        laneCommands.add({ LaneCommand::Type::reset });
+
+    // The block is split at each incoming note, so that chord changes happen
+    // on the sample where the key was pressed, whatever the buffer size.
+    bool notesChanged = false;
+    int segmentStart = 0;
+    for (const auto& note : inputNotes)
+    {
+        // Notes landing on the same sample are applied together, as one chord change.
+        const int samplePosition = juce::jlimit(0, numSamples, note.samplePosition);
+        if (samplePosition > segmentStart)
         {
-            heldNotes.addIfNotAlreadyThere(msg.getNoteNumber());
+            if (notesChanged)
+                addChordCommand(segmentStart);
+            notesChanged = false;
+
+            addRenderCommand(segmentStart, samplePosition);
+            segmentStart = samplePosition;
+        }
+
+        if (note.isNoteOn)
+        {
+            // With the host stopped, the first key starts all the lanes on it, together.
+            if (heldNotes.isEmpty() && !transport.isPlaying())
+                transport.restartAt(samplePosition);
+
+            heldNotes.add(note.noteNumber);
             // Update the arpeggiator's velocity based on the incoming note's velocity, only for active arps.
-            for (int i = 0; i < arpeggiators.size(); ++i)
-                if (arpeggiatorOnStates[i])
-                    arpeggiators.getReference(i).setGlobalVelocityFromMidi(msg.getVelocity());
-            notesChanged = true;
+            LaneCommand command { LaneCommand::Type::setVelocity, samplePosition };
+            command.velocity = note.velocity;
+            laneCommands.add(command);
         }
-        else if (msg.isNoteOff())
+        else
         {
-            heldNotes.removeFirstMatchingValue(msg.getNoteNumber());
-            notesChanged = true;
+            heldNotes.remove(note.noteNumber);
         }
+        notesChanged = true;
     }
 
     if (notesChanged)
+        addChordCommand(segmentStart);
+    addRenderCommand(segmentStart, numSamples);
+
+    // --- Run the lanes, each into its own buffer ---
+    // The lanes only share read-only state, so the worker threads give the
+    // same output as running them here one after the other.
+    if (workerPool != nullptr && numBlockLanes >= parallelLaneThreshold)
+        workerPool->run(*this, numBlockLanes);
+    else
+        for (int i = 0; i < numBlockLanes; ++i)
+            renderLane(blockLanes[(size_t) i]);
+
+    // We clear the incoming buffer and merge the lanes straight into it.
+    // Its storage is kept, so this only allocates if the host gave us a smaller buffer.
+    midiMessages.clear();
+    midiMessages.ensureSize(outputBufferSize);
+
+    std::array<const juce::MidiBuffer*, maxNumArpeggiators> lanesToMerge;
+    for (int i = 0; i < numBlockLanes; ++i)
+        lanesToMerge[(size_t) i] = &laneBuffers[(size_t) blockLanes[(size_t) i]];
+    LaneMerger::merge(lanesToMerge.data(), numBlockLanes, midiMessages);
+
+    publishTelemetry();
+
+    // this code if your algorithm always overwrites all the output channels.
+    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+        buffer.clear (i, 0, numSamples);
+}
+
+void TeArAudioProcessor::addChordCommand (int samplePosition)
+{
+    LaneCommand command { LaneCommand::Type::setChord, samplePosition };
+    auto chordMethod = static_cast<int>(parameters.chordMethod->load());
+
+    switch (chordMethod)
     {
-        MidiTools::Chord playedChord("");
-        auto chordMethod = static_cast<int>(apvts.getRawParameterValue("chordMethod")->load());
+        case 0: // Notes played
+            command.chord = ArpChord::fromPitchClasses(heldNotes.getNotesInPlayOrder());
+            break;
+        case 1: // Chord played as is
+            command.chord = ArpChord::fromNotes(heldNotes.getNotesInPlayOrder());
+            break;
+        case 2: // Single note
+            if (!heldNotes.isEmpty())
+            {
+                int lastNote = heldNotes.getLast();
+                int lastNoteSemitone = lastNote % 12;
 
-        switch (chordMethod)
-        {
-            case 0: // Notes played
-                playedChord.setDegreesByArray(heldNotes);
-                break;
-            case 1: // Chord played as is
-                playedChord.setNotesByArray(heldNotes);
-                break;
-            case 2: // Single note
-                if (!heldNotes.isEmpty())
+                auto followMidiIn = parameters.followMidiIn->load();
+                auto scaleTypeIndex = static_cast<int>(parameters.scaleType->load());
+                auto rootNoteIndex = static_cast<int>(parameters.scaleRoot->load());
+
+                if (followMidiIn)
                 {
-                    int lastNote = heldNotes.getLast();
-                    int lastNoteSemitone = lastNote % 12;
-
-                    auto followMidiIn = apvts.getRawParameterValue("followMidiIn")->load();
-                    auto scaleTypeIndex = static_cast<int>(apvts.getRawParameterValue("scaleType")->load());
-                    auto scaleType = static_cast<MidiTools::Scale::Type>(scaleTypeIndex);
-
-                    if (followMidiIn)
-                    {
-                        // The incoming note sets the root of the scale.
-                        // We update the parameter, which will also update the UI.
-                        apvts.getParameter("scaleRoot")->setValueNotifyingHost(lastNoteSemitone / 11.0f);
-
-                        MidiTools::Scale currentScale(lastNoteSemitone, scaleType);
-                        // Set the arpeggiator's base octave from the played note, only for active arps.
-                        for (int i = 0; i < arpeggiators.size(); ++i)
-                            if (arpeggiatorOnStates[i])
-                                arpeggiators.getReference(i).setBaseOctaveFromNote(lastNote);
-                        // The chord is built from the root of this new scale.
-                        playedChord = MidiTools::Chord::fromScaleAndDegree(currentScale, 0);
-                    }
-                    else
-                    {
-                        // Use the fixed scale from the UI to find the degree of the played note.
-                        auto rootNoteIndex = static_cast<int>(apvts.getRawParameterValue("scaleRoot")->load());
-                        MidiTools::Scale currentScale(rootNoteIndex, scaleType);
-                        const auto& scaleNotes = currentScale.getNotes();
-                        int degree = scaleNotes.indexOf(lastNoteSemitone);
-
-                        if (degree != -1) // If the note is in the scale
-                        {
-                            for (int i = 0; i < arpeggiators.size(); ++i)
-                                if (arpeggiatorOnStates[i])
-                                    arpeggiators.getReference(i).setBaseOctaveFromNote(lastNote);
-                            playedChord = MidiTools::Chord::fromScaleAndDegree(currentScale, degree);
-                        }
-                        else // Note is not in scale, find nearest below
-                        {
-                            int nearestDegree = -1;
-                            for (int i = 1; i < 12; ++i)
-                            {
-                                int semitoneToTest = (lastNoteSemitone - i + 12) % 12;
-                                int foundDegree = scaleNotes.indexOf(semitoneToTest);
-                                if (foundDegree != -1)
-                                {
-                                    nearestDegree = foundDegree;
-                                    break;
-                                }
-                            }
-                            for (int i = 0; i < arpeggiators.size(); ++i)
-                                if (arpeggiatorOnStates[i])
-                                    arpeggiators.getReference(i).setBaseOctaveFromNote(lastNote);
-                            playedChord = MidiTools::Chord::fromScaleAndDegree(currentScale, nearestDegree != -1 ? nearestDegree : 0);
-                        }
-                    }
+                    // The incoming note sets the root of the scale. The host
+                    // and the UI learn about it later, from the message thread.
+                    queueFollowedRoot(lastNoteSemitone);
+                    rootNoteIndex = lastNoteSemitone;
                 }
-                break;
-        }
-        // Set chord for all active arpeggiators
-        for (int i = 0; i < arpeggiators.size(); ++i)
-            if (arpeggiatorOnStates[i]) arpeggiators.getReference(i).setChord(playedChord);
-        // std::cout << "Notes: " ;
-        // for (int note : heldNotes)
-        //     std::cout << note << " ";
-        // std::cout << std::endl;
-        // std::cout << "Chord: " << playedChord.getName() << std::endl;
-    }
 
-    // We clear the incoming buffer and fill it with arpeggiator output
-    midiMessages.clear();
+                // The table gives the chord on the degree of the played note,
+                // or on the nearest degree below it if the note is not in the scale.
+                command.baseOctaveNote = lastNote;
+                command.chord = scaleTable.getChord(rootNoteIndex, scaleTypeIndex, lastNoteSemitone);
+            }
+            break;
+    }
 
     // If the user just released the last key, send a note off.
-    if (notesChanged && heldNotes.isEmpty())
+    command.turnOff = heldNotes.isEmpty();
+    laneCommands.add(command);
+
+    // The UI shows the notes of the chord, or its degrees when they are not played as is.
+    chordPitchClasses = command.chord.pitchClasses;
+    chordRoot = command.chord.getRootPitchClass();
+}
+
+void TeArAudioProcessor::queueFollowedRoot (int root) noexcept
+{
+    if (followedRoot.exchange(root, std::memory_order_relaxed) == root)
+        return;
+
+    // If the message thread falls this far behind, the change is dropped
+    // and the message thread takes the root from followedRoot instead.
+    const auto scope = followedRootFifo.write(1);
+    if (scope.blockSize1 > 0)
+        followedRootQueue[(size_t) scope.startIndex1] = root;
+    else
+        followedRootDropped = true;
+}
+
+void TeArAudioProcessor::timerCallback()
+{
+    int root = -1;
     {
-        for (int i = 0; i < arpeggiators.size(); ++i)
-            if (arpeggiatorOnStates[i])
-                midiMessages.addEvents(arpeggiators.getReference(i).turnOff(arpeggiatorMidiChannels[i]), 0, -1, 0);
+        const auto scope = followedRootFifo.read(followedRootFifo.getNumReady());
+        if (scope.blockSize2 > 0)
+            root = followedRootQueue[(size_t) (scope.startIndex2 + scope.blockSize2 - 1)];
+        else if (scope.blockSize1 > 0)
+            root = followedRootQueue[(size_t) (scope.startIndex1 + scope.blockSize1 - 1)];
     }
-    // If the transport just stopped, also send a note off.
-    // This is placed after the clear() call to ensure the message is not erased.
-    if (transportJustStopped)
+
+    if (followedRootDropped.exchange(false))
+        root = getFollowedRoot();
+
+    // Only the latest root is written: the ones before it would all get the
+    // same time in the host's automation anyway.
+    if (root < 0 || parameters.followMidiInAutomation->load() < 0.5f)
+        return;
+
+    auto* parameter = parameters.scaleRootParameter;
+    const auto newValue = parameter->convertTo0to1(static_cast<float>(root));
+    if (parameter->getValue() == newValue)
+        return;
+
+    isWritingFollowedRoot = true;
+    parameter->beginChangeGesture();
+    parameter->setValueNotifyingHost(newValue);
+    parameter->endChangeGesture();
+    isWritingFollowedRoot = false;
+}
+
+void TeArAudioProcessor::addRenderCommand (int startSample, int endSample)
+{
+    // With no key held, the lanes have nothing to do. They need not keep the
+    // grid either: while the host plays, it comes from its position.
+    if (endSample <= startSample || heldNotes.isEmpty())
+        return;
+
+    LaneCommand command { LaneCommand::Type::render, startSample };
+    command.endSample = endSample;
+    laneCommands.add(command);
+}
+
+void TeArAudioProcessor::renderLane (int index)
+{
+    auto& arp = arpeggiators[(size_t) index];
+    auto& output = laneBuffers[(size_t) index];
+    const int midiChannel = arpeggiatorMidiChannels[(size_t) index];
+
+    output.clear();
+
+    for (const auto& command : laneCommands)
     {
-        for (int i = 0; i < arpeggiators.size(); ++i)
-            if (arpeggiatorOnStates[i])
-                midiMessages.addEvents(arpeggiators.getReference(i).reset(arpeggiatorMidiChannels[i]), 0, -1, 0);
+        switch (command.type)
+        {
+            case LaneCommand::Type::reset:
+                arp.reset(output, command.samplePosition);
+                break;
+            case LaneCommand::Type::render:
+                arp.processBlock(output, transport, command.samplePosition, command.endSample, midiChannel);
+                break;
+            case LaneCommand::Type::setVelocity:
+                arp.setGlobalVelocityFromMidi(command.velocity);
+                break;
+            case LaneCommand::Type::setChord:
+                if (command.baseOctaveNote >= 0)
+                    arp.setBaseOctaveFromNote(command.baseOctaveNote);
+                arp.setChord(command.chord);
+                if (command.turnOff)
+                    arp.turnOff(output, command.samplePosition);
+                break;
+        }
     }
+}
 
+void TeArAudioProcessor::runJob (int index) noexcept
+{
+    renderLane(blockLanes[(size_t) index]);
+}
 
-    // this code if your algorithm always overwrites all the output channels.
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
+void TeArAudioProcessor::publishTelemetry()
+{
+    auto& snapshot = telemetry.getSnapshotToWrite();
 
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels. Alternatively,
-    // you can process the samples with the channels interleaved by keeping the same state.
-    if (!heldNotes.isEmpty())
-        for (int i = 0; i < arpeggiators.size(); ++i)
-            if (arpeggiatorOnStates[i])
-                midiMessages.addEvents(arpeggiators.getReference(i).processBlock(buffer.getNumSamples(), arpeggiatorMidiChannels[i]), 0, -1, 0);
+    snapshot.activeLanes = 0;
+    for (int i = 0; i < numBlockLanes; ++i)
+        snapshot.activeLanes |= (juce::uint32) 1 << blockLanes[(size_t) i];
+
+    for (int i = 0; i < numArpeggiators; ++i)
+    {
+        const auto& arp = arpeggiators[(size_t) i];
+        snapshot.currentStep[(size_t) i] = arp.getCurrentStepIndex();
+        snapshot.lastNote[(size_t) i] = arp.getLastPlayedNote();
+    }
+
+    snapshot.chordPitchClasses = chordPitchClasses;
+    snapshot.chordRoot = chordRoot;
+    snapshot.notesHeld = !heldNotes.isEmpty();
+
+    telemetry.publish();
 }
 
 //==============================================================================
@@ -356,91 +524,219 @@ juce::AudioProcessorEditor* TeArAudioProcessor::createEditor()
 }
 
 //==============================================================================
+namespace
+{
+    // The binary state, little-endian:
+    //   "TeAr", the version, the number of global values, the number of lanes
+    //   and the number of values per lane, as 32-bit ints;
+    //   the plain values of the global parameters, as floats;
+    //   for each lane, the plain values of its parameters, then its pattern
+    //   as a 32-bit byte count and UTF-8 text;
+    //   from version 2, the random seed as a 64-bit int;
+    //   from version 3, the root followed from the MIDI input, or -1, as a
+    //   32-bit int (it is not a parameter, so that the host does not record it).
+    // Readers skip the values they do not know and set the parameters and
+    // lanes that are missing to their default values, so that parameters can
+    // be added without breaking older or newer sessions. A chunk that ends
+    // before its last pattern is refused as a whole.
+    constexpr int stateMagic = 0x72416554; // "TeAr"
+    constexpr int stateVersion = 3;
+    constexpr int stateHeaderSize = 5 * 4;
+}
+
 void TeArAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // Get the state from APVTS
-    auto apvtsState = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml (apvtsState.createXml());
+    juce::MemoryOutputStream stream (destData, false);
 
-    // Manually add our string parameters to the XML
-    for (int i = 0; i < arpeggiatorPatterns.size(); ++i)
-        xml->setAttribute("arpeggiatorPattern" + juce::String(i), arpeggiatorPatterns[i]);
-    for (int i = 0; i < arpeggiatorOnStates.size(); ++i)
-        xml->setAttribute("arpOn" + juce::String(i), arpeggiatorOnStates[i]);
+    stream.writeInt(stateMagic);
+    stream.writeInt(stateVersion);
+    stream.writeInt(parameters.globalParameters.size());
+    stream.writeInt(numArpeggiators);
+    stream.writeInt(parameters.numParametersPerLane);
 
-    // Convert the XML to binary and store it.
-    copyXmlToBinary(*xml, destData);
+    auto writeValue = [&stream](const juce::RangedAudioParameter* parameter)
+    {
+        stream.writeFloat(parameter->convertFrom0to1(parameter->getValue()));
+    };
+
+    for (auto* parameter : parameters.globalParameters)
+        writeValue(parameter);
+
+    for (int i = 0; i < numArpeggiators; ++i)
+    {
+        for (int j = 0; j < parameters.numParametersPerLane; ++j)
+            writeValue(parameters.laneParameters.getUnchecked(i * parameters.numParametersPerLane + j));
+
+        const auto& pattern = arpeggiatorPatterns.getReference(i);
+        const auto numBytes = pattern.getNumBytesAsUTF8();
+        stream.writeInt((int) numBytes);
+        stream.write(pattern.toRawUTF8(), numBytes);
+    }
+
+    stream.writeInt64(getRandomSeed());
+    stream.writeInt(getFollowedRoot());
 }
 
 void TeArAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
- 
-    if (xmlState != nullptr)
+    // Sessions saved before the binary state hold XML.
+    if (!readBinaryState(data, sizeInBytes) && !readXmlState(data, sizeInBytes))
+        return;
+
+    // Sync cached MIDI channels from APVTS. The lane settings reach the
+    // engines through parameterChanged().
+    for (int i = 0; i < numArpeggiators; ++i)
+        arpeggiatorMidiChannels[(size_t) i] = static_cast<int>(parameters.midiChannel[i]->load());
+
+    // Notify listeners (like the editor) that our manual state has changed.
+    sendChangeMessage();
+}
+
+bool TeArAudioProcessor::readBinaryState (const void* data, int sizeInBytes)
+{
+    if (data == nullptr || sizeInBytes < stateHeaderSize)
+        return false;
+
+    juce::MemoryInputStream stream (data, (size_t) sizeInBytes, false);
+
+    if (stream.readInt() != stateMagic)
+        return false;
+
+    const int version = stream.readInt();
+    if (version < 1)
+        return false;
+
+    const int numGlobalValues = stream.readInt();
+    const int numLanes = stream.readInt();
+    const int numValuesPerLane = stream.readInt();
+
+    // Every value takes 4 bytes and every lane at least 4 more for its pattern.
+    const auto numBytesNeeded = 4 * ((juce::int64) numGlobalValues + (juce::int64) numLanes * (numValuesPerLane + 1));
+    if (numGlobalValues < 0 || numLanes < 0 || numValuesPerLane < 0 || numBytesNeeded > stream.getNumBytesRemaining())
+        return false;
+
+    // A truncated chunk is refused before anything is changed, rather than
+    // applied in part.
     {
-        // Restore the APVTS state
-        if (xmlState->hasTagName (apvts.state.getType()))
-            apvts.replaceState (juce::ValueTree::fromXml (*xmlState));
+        juce::MemoryInputStream check (data, (size_t) sizeInBytes, false);
+        check.setPosition(stream.getPosition() + 4 * (juce::int64) numGlobalValues);
 
-        // Sync cached MIDI channels and subdivisions from APVTS
-        for (int i = 0; i < arpeggiatorMidiChannels.size(); ++i)
+        for (int i = 0; i < numLanes; ++i)
         {
-            if (auto* p = apvts.getRawParameterValue("midiChannel" + juce::String(i + 1)))
-                arpeggiatorMidiChannels.set(i, static_cast<int>(*p));
+            check.skipNextBytes(4 * (juce::int64) numValuesPerLane);
+            const int numBytes = check.readInt();
+            if (numBytes < 0 || numBytes > check.getNumBytesRemaining())
+                return false;
 
-            if (auto* p = apvts.getRawParameterValue("subdivision" + juce::String(i + 1)))
-                arpeggiators.getReference(i).setSubdivision(static_cast<int>(*p));
+            check.skipNextBytes(numBytes);
         }
+    }
 
-        // Manually restore our string parameters from the same XML
-        for (int i = 0; i < arpeggiatorPatterns.size(); ++i)
-        {
-            juce::String attributeName = "arpeggiatorPattern" + juce::String(i);
-            if (xmlState->hasAttribute(attributeName))
-            {
-                arpeggiatorPatterns.set(i, xmlState->getStringAttribute(attributeName, "0 1 2"));
-                arpeggiators.getReference(i).setPattern(arpeggiatorPatterns[i]);
-            }
-        }
-        for (int i = 0; i < arpeggiatorOnStates.size(); ++i)
+    auto readValue = [&stream](juce::RangedAudioParameter* parameter)
+    {
+        const auto value = stream.readFloat();
+        if (parameter != nullptr && std::isfinite(value))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    };
+
+    // Parameters added after the state was saved get their default value.
+    auto resetValue = [](juce::RangedAudioParameter* parameter)
+    {
+        parameter->setValueNotifyingHost(parameter->getDefaultValue());
+    };
+
+    for (int i = 0; i < numGlobalValues; ++i)
+        readValue(parameters.globalParameters[i]);
+    for (int i = numGlobalValues; i < parameters.globalParameters.size(); ++i)
+        resetValue(parameters.globalParameters.getUnchecked(i));
+
+    for (int i = 0; i < numLanes; ++i)
+    {
+        const bool isKnownLane = i < numArpeggiators;
+
+        for (int j = 0; j < numValuesPerLane; ++j)
+            readValue(isKnownLane && j < parameters.numParametersPerLane
+                          ? parameters.laneParameters.getUnchecked(i * parameters.numParametersPerLane + j)
+                          : nullptr);
+        for (int j = numValuesPerLane; isKnownLane && j < parameters.numParametersPerLane; ++j)
+            resetValue(parameters.laneParameters.getUnchecked(i * parameters.numParametersPerLane + j));
+
+        const int numBytes = stream.readInt();
+        if (isKnownLane)
+            restorePattern(i, juce::String::fromUTF8(static_cast<const char*>(data) + stream.getPosition(), numBytes));
+
+        stream.skipNextBytes(numBytes);
+    }
+
+    // Lanes added after the state was saved start as in a new instance.
+    for (int i = numLanes; i < numArpeggiators; ++i)
+    {
+        for (int j = 0; j < parameters.numParametersPerLane; ++j)
+            resetValue(parameters.laneParameters.getUnchecked(i * parameters.numParametersPerLane + j));
+
+        restorePattern(i, defaultPattern);
+    }
+
+    // Older sessions keep the seed of the instance, which they are saved with from now on.
+    if (version >= 2 && stream.getNumBytesRemaining() >= 8)
+        setRandomSeed(stream.readInt64());
+
+    // After the parameters, whose listeners forget the followed root.
+    if (version >= 3 && stream.getNumBytesRemaining() >= 4)
+    {
+        const int root = stream.readInt();
+        followedRoot = juce::isPositiveAndBelow(root, 12) ? root : -1;
+    }
+
+    return true;
+}
+
+bool TeArAudioProcessor::readXmlState (const void* data, int sizeInBytes)
+{
+    std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
+ 
+    if (xmlState == nullptr)
+        return false;
+
+    // Restore the APVTS state
+    if (xmlState->hasTagName (apvts.state.getType()))
+        apvts.replaceState (juce::ValueTree::fromXml (*xmlState));
+
+    // Manually restore our string parameters from the same XML
+    for (int i = 0; i < arpeggiatorPatterns.size(); ++i)
+    {
+        juce::String attributeName = "arpeggiatorPattern" + juce::String(i);
+        if (xmlState->hasAttribute(attributeName))
+            restorePattern(i, xmlState->getStringAttribute(attributeName, "0 1 2"));
+    }
+    for (int i = 0; i < numArpeggiators; ++i)
+    {
+        juce::String attributeName = "arpOn" + juce::String(i);
+        if (xmlState->hasAttribute(attributeName))
         {
-            juce::String attributeName = "arpOn" + juce::String(i);
-            if (xmlState->hasAttribute(attributeName))
-            {
-                arpeggiatorOnStates.set(i, xmlState->getBoolAttribute(attributeName, true));
-            }
+            setLaneOn(i, xmlState->getBoolAttribute(attributeName, true));
         }
-        // Notify listeners (like the editor) that our manual state has changed.
-        sendChangeMessage();
     }
+
+    return true;
+}
+
+void TeArAudioProcessor::restorePattern (int index, const juce::String& pattern)
+{
+    arpeggiatorPatterns.set(index, pattern);
+    compiledPatterns.set(index, PatternCache::getInstance()->getPattern(pattern));
+    patternHandoffs.getUnchecked(index)->submit(compiledPatterns[index]);
 }
 
 void TeArAudioProcessor::setArpeggiatorPattern(int index, const juce::String& pattern)
 {
     if (juce::isPositiveAndBelow(index, arpeggiatorPatterns.size()))
     {
+        // Compile here, on the message thread: the audio thread only swaps
+        // the compiled pattern in at the start of its next block.
         arpeggiatorPatterns.set(index, pattern);
-        arpeggiators.getReference(index).setPattern(pattern);
-
-        // If the pattern of an arp changed and the DAW is not playing, sync it to another running arp.
-        // This ensures that when playback is stopped, all arps remain rhythmically aligned.
-        if (!wasPlaying && arpeggiatorOnStates[index])
-        {
-            double masterSamplesUntilNext = -1.0;
-            // Find a running arpeggiator to use as the master clock
-            for (int i = 0; i < arpeggiators.size(); ++i)
-            {
-                if (i != index && arpeggiatorOnStates[i])
-                {
-                    masterSamplesUntilNext = arpeggiators[i].getSamplesUntilNextNote();
-                    break;
-                }
-            }
-
-            // If we found a master, sync the arpeggiator whose pattern just changed.
-            if (masterSamplesUntilNext >= 0.0)
-                arpeggiators.getReference(index).setSamplesUntilNextNote(masterSamplesUntilNext);
-        }
+        compiledPatterns.set(index, PatternCache::getInstance()->getPattern(pattern));
+        patternHandoffs.getUnchecked(index)->submit(compiledPatterns[index]);
 
         // Notify the editor that the pattern has changed so it can update the text box.
         sendChangeMessage();
@@ -458,100 +754,101 @@ const juce::String& TeArAudioProcessor::getArpeggiatorPattern(int index) const
 
 void TeArAudioProcessor::randomizeArpeggiator(int index)
 {
-    if (juce::isPositiveAndBelow(index, arpeggiators.size()))
-    {
-        arpeggiators.getReference(index).randomize();
-        // Update the stored pattern string to match the new random pattern
-        arpeggiatorPatterns.set(index, arpeggiators.getReference(index).getPattern());
-        sendChangeMessage(); // Notify the editor to update the text box
-    }
+    if (juce::isPositiveAndBelow(index, numArpeggiators))
+        setArpeggiatorPattern(index, PatternGenerator::makeRandomPattern(getNextPatternSeed(index))); // Also notifies the editor
+}
+
+void TeArAudioProcessor::setRandomSeed(juce::int64 seed)
+{
+    randomSeed.store(seed, std::memory_order_relaxed);
+    numRandomPatterns.fill(0);
+}
+
+juce::int64 TeArAudioProcessor::getNextPatternSeed(int index)
+{
+    jassert(juce::isPositiveAndBelow(index, numArpeggiators));
+
+    // A stream of its own per lane, apart from the ones the lanes play with.
+    const CounterRandom random ((juce::uint64) getRandomSeed(), (juce::uint64) (maxNumArpeggiators + index));
+    return (juce::int64) random.getBits(numRandomPatterns[(size_t) index]++);
 }
 
 bool TeArAudioProcessor::isArpeggiatorOn(int index) const
 {
-    if (juce::isPositiveAndBelow(index, arpeggiatorOnStates.size()))
-        return arpeggiatorOnStates[index];
+    if (juce::isPositiveAndBelow(index, numArpeggiators))
+        return (activeLanes.load(std::memory_order_relaxed) >> index) & 1;
     return false;
 }
-int TeArAudioProcessor::getArpeggiatorCurrentStep(int index) const
+
+void TeArAudioProcessor::setLaneOn(int index, bool shouldBeOn) noexcept
 {
-    if (juce::isPositiveAndBelow(index, arpeggiators.size()))
-        return arpeggiators.getUnchecked(index).getCurrentStepIndex();
-    return 0;
+    const auto bit = (juce::uint32) 1 << index;
+    if (shouldBeOn)
+        activeLanes.fetch_or(bit, std::memory_order_relaxed);
+    else
+        activeLanes.fetch_and(~bit, std::memory_order_relaxed);
 }
-
-const Arpeggiator& TeArAudioProcessor::getArpeggiator(int index) const
+const ArpPattern* TeArAudioProcessor::getCompiledArpeggiatorPattern(int index) const
 {
-    return arpeggiators.getReference(index);
+    return compiledPatterns[index].get();
 }
 
-bool TeArAudioProcessor::areNotesHeld() const
+const LaneTelemetry::Snapshot& TeArAudioProcessor::getTelemetry()
 {
-    return !heldNotes.isEmpty();
+    return telemetry.read();
 }
 
 void TeArAudioProcessor::parameterChanged (const juce::String& parameterID, float newValue)
 {
-    if (parameterID.startsWith("arpOn"))
-    {
-        int arpIndex = parameterID.getLastCharacter() - '1';
-        if (juce::isPositiveAndBelow(arpIndex, arpeggiatorOnStates.size()))
-        {
-            arpeggiatorOnStates.set(arpIndex, newValue > 0.5f);
+    if (!parameterTargets.contains(parameterID))
+        return;
 
-            // If we just turned an arp ON and the DAW is not playing, sync it to another running arp.
-            if (newValue > 0.5f && !wasPlaying)
-            {
-                double masterSamplesUntilNext = -1.0;
-                // Find a running arpeggiator to use as the master clock
-                for (int i = 0; i < arpeggiators.size(); ++i)
-                {
-                    if (i != arpIndex && arpeggiatorOnStates[i])
-                    {
-                        masterSamplesUntilNext = arpeggiators[i].getSamplesUntilNextNote();
-                        break;
-                    }
-                }
+    const auto target = parameterTargets[parameterID];
+    const int arpIndex = target.arpIndex;
 
-                // If we found a master, sync the newly enabled arpeggiator to it.
-                if (masterSamplesUntilNext >= 0.0)
-                    arpeggiators.getReference(arpIndex).setSamplesUntilNextNote(masterSamplesUntilNext);
-            }
-        }
-    }
-    if (parameterID.startsWith("midiChannel"))
-    {
-        int arpIndex = parameterID.getLastCharacter() - '1';
-        if (juce::isPositiveAndBelow(arpIndex, arpeggiatorMidiChannels.size()))
-        {
-            arpeggiatorMidiChannels.set(arpIndex, static_cast<int>(newValue));
-        }
-    }
-    if (parameterID.startsWith("subdivision"))
-    {
-        int arpIndex = parameterID.getLastCharacter() - '1';
-        if (juce::isPositiveAndBelow(arpIndex, arpeggiators.size()))
-        {
-            arpeggiators.getReference(arpIndex).setSubdivision(static_cast<int>(newValue));
-        }
-    }
-    else if (parameterID == "chordMethod")
-    {
-        for (int i = 0; i < arpeggiators.size(); ++i)
-        {
-            auto& arp = arpeggiators.getReference(i);
-            arp.setChordMethod(static_cast<int>(newValue)); // TODO: This should probably be passed to reset
-            arp.reset();
-        }
-    }
-    else if (parameterID == "scaleRoot")
-    {
-    }
-    else if (parameterID == "scaleType")
-    {
-    }
-    else if (parameterID == "followMidiIn")
+    switch (target.kind)
     {
+        case ParameterKind::arpOn:
+            // The lanes share one clock, so a lane turned on plays in step with the others.
+            setLaneOn(arpIndex, newValue > 0.5f);
+            break;
+        case ParameterKind::midiChannel:
+            arpeggiatorMidiChannels[(size_t) arpIndex] = static_cast<int>(newValue);
+            break;
+        case ParameterKind::subdivision:
+            arpeggiators[(size_t) arpIndex].setSubdivision(static_cast<int>(newValue));
+            break;
+        case ParameterKind::gate:
+            arpeggiators[(size_t) arpIndex].setGate(static_cast<int>(newValue));
+            break;
+        case ParameterKind::swing:
+            arpeggiators[(size_t) arpIndex].setSwing(static_cast<int>(newValue));
+            break;
+        case ParameterKind::voicing:
+            arpeggiators[(size_t) arpIndex].setVoicing(static_cast<ArpEngine::Voicing>(static_cast<int>(newValue)));
+            break;
+        case ParameterKind::chordMethod:
+            for (int i = 0; i < numArpeggiators; ++i)
+            {
+                auto& arp = arpeggiators[(size_t) i];
+                // The lane takes the new method at its next chord or block,
+                // whichever comes first, and restarts its pattern at its next block.
+                arp.setChordMethod(static_cast<int>(newValue));
+                arp.requestReset();
+            }
+            break;
+        case ParameterKind::scaleRoot:
+            // A root chosen by the user, rather than written by timerCallback(),
+            // replaces the followed one until the next key.
+            if (!isWritingFollowedRoot)
+                followedRoot = -1;
+            break;
+        case ParameterKind::followMidiIn:
+            followedRoot = -1;
+            break;
+        case ParameterKind::scaleType:
+        case ParameterKind::followMidiInAutomation:
+            break;
     }
 }
 
@@ -566,7 +863,7 @@ juce::AudioProcessorValueTreeState::ParameterLayout TeArAudioProcessor::createPa
         chordMethods,
         1)); // Default to "Chord played as is"
 
-    for (int i = 0; i < 4; ++i)
+    for (int i = 0; i < numArpeggiators; ++i)
     {
         layout.add(std::make_unique<juce::AudioParameterBool>(
             "arpOn" + juce::String(i + 1),
@@ -575,16 +872,16 @@ juce::AudioProcessorValueTreeState::ParameterLayout TeArAudioProcessor::createPa
         ));
     }
 
-    for (int i = 0; i < 4; ++i)
+    for (int i = 0; i < numArpeggiators; ++i)
     {
         layout.add(std::make_unique<juce::AudioParameterInt>(
             "midiChannel" + juce::String(i + 1),
             "MIDI Channel " + juce::String(i + 1),
-            1, 16, i + 1 // min, max, default (1, 2, 3, 4)
+            1, 16, i + 1 // min, max, default (one channel per lane)
         ));
     }
 
-    for (int i = 0; i < 4; ++i)
+    for (int i = 0; i < numArpeggiators; ++i)
     {
         juce::StringArray subdivisions = { "1/4", "1/4T", "1/8", "1/8T", "1/16", "1/16T", "1/32", "1/32T", "1/64", "1/64T" };
         layout.add(std::make_unique<juce::AudioParameterChoice>(
@@ -595,6 +892,29 @@ juce::AudioProcessorValueTreeState::ParameterLayout TeArAudioProcessor::createPa
         ));
     }
 
+    for (int i = 0; i < numArpeggiators; ++i)
+    {
+        layout.add(std::make_unique<juce::AudioParameterInt>(
+            "gate" + juce::String(i + 1),
+            "Gate " + juce::String(i + 1),
+            1, 100, 100 // Percent of the time until the next step, default: until the next step
+        ));
+
+        layout.add(std::make_unique<juce::AudioParameterInt>(
+            "swing" + juce::String(i + 1),
+            "Swing " + juce::String(i + 1),
+            0, 100, 0 // Percent of half a step that odd steps are late, default: none
+        ));
+
+        juce::StringArray voicings = { "Close", "Spread", "Drop 2" };
+        layout.add(std::make_unique<juce::AudioParameterChoice>(
+            "voicing" + juce::String(i + 1),
+            "Voicing " + juce::String(i + 1),
+            voicings,
+            0 // Default to the chord as it is
+        ));
+    }
+
     juce::StringArray scaleRoots = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
     layout.add(std::make_unique<juce::AudioParameterChoice>(
         "scaleRoot",
@@ -616,6 +936,12 @@ juce::AudioProcessorValueTreeState::ParameterLayout TeArAudioProcessor::createPa
         false // Default to false
     ));
 
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        "followMidiInAutomation",
+        "Follow MIDI In Automation",
+        false // The followed root is not written to the host by default
+    ));
+
     return layout;
 }
 
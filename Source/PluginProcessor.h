@@ -9,7 +9,18 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "libs/cppMusicTools/Arpeggiator.h"
+#include "ArpEngine.h"
+#include "PatternHandoff.h"
+#include "HeldNoteSet.h"
+#include "ScaleTable.h"
+#include "LaneWorkerPool.h"
+#include "LaneTelemetry.h"
+#include "TransportTracker.h"
+
+// Number of arpeggiator lanes of the plugin, from 1 to 16 (one per MIDI channel)
+#ifndef TEAR_NUM_ARPS
+ #define TEAR_NUM_ARPS 4
+#endif
 
 //==============================================================================
 /**
@@ -17,12 +28,28 @@
 class TeArAudioProcessor  : public juce::AudioProcessor
                           , public juce::ChangeBroadcaster
                           , public juce::AudioProcessorValueTreeState::Listener
+                          , private LaneWorkerPool::Job
+                          , private juce::Timer
 {
 public:
     //==============================================================================
-    TeArAudioProcessor();
+    static constexpr int maxNumArpeggiators = 16;
+
+    explicit TeArAudioProcessor (int numArpeggiatorsToUse = TEAR_NUM_ARPS);
     ~TeArAudioProcessor() override;
 
+    int getNumArpeggiators() const { return numArpeggiators; }
+
+    // From this many active lanes on, the lanes of a block are shared between
+    // the audio thread and a few worker threads. This is a default that has
+    // not been measured yet: compare TeArBench with and without --serial to
+    // find where the threads start to pay for themselves.
+    static constexpr int parallelLaneThreshold = 8;
+
+    // Whether prepareToPlay() may start the worker threads (true by default).
+    // The output is the same either way.
+    void setUseWorkerThreads (bool shouldUseWorkerThreads);
+
     //==============================================================================
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
@@ -62,32 +89,182 @@ public:
     void setArpeggiatorPattern (int index, const juce::String& pattern);
     const juce::String& getArpeggiatorPattern(int index) const;
     void randomizeArpeggiator(int index);
+
+    // The seed of the random choices of the lanes and of the random patterns,
+    // saved with the state, so that renders can be reproduced
+    void setRandomSeed(juce::int64 seed);
+    juce::int64 getRandomSeed() const noexcept { return randomSeed.load(std::memory_order_relaxed); }
+    // The seed of the next random pattern of a lane: with the same seed, the
+    // random patterns of a lane come in the same order (message thread only)
+    juce::int64 getNextPatternSeed(int index);
     bool isArpeggiatorOn(int index) const;
 
-    // Getter for the UI to know the current step
-    int getArpeggiatorCurrentStep(int index) const;
+    // Getter for the UI to map steps to the pattern text (message thread only)
+    const ArpPattern* getCompiledArpeggiatorPattern(int index) const;
 
-    // Getter for the UI to access arpeggiator methods
-    const Arpeggiator& getArpeggiator(int index) const;
+    // The state of the lanes as of the last block, for the UI (message thread only)
+    const LaneTelemetry::Snapshot& getTelemetry();
 
-    // Getter for the UI to know if notes are being held
-    bool areNotesHeld() const;
+    // The root set by the last key played with "Follow MIDI In" on, or -1 when
+    // the root is the one of the scaleRoot parameter
+    int getFollowedRoot() const noexcept { return followedRoot.load(std::memory_order_relaxed); }
 
     juce::AudioProcessorValueTreeState& getAPVTS() { return apvts; }
 
 private:
+    const int numArpeggiators;
+
+    // The pattern of a lane in a new instance
+    static constexpr const char* defaultPattern = "1 2 3";
+
     juce::StringArray arpeggiatorPatterns;
+    juce::Array<ArpPattern::Ptr> compiledPatterns;
+    juce::OwnedArray<PatternHandoff> patternHandoffs;
 
     juce::AudioProcessorValueTreeState apvts;
     juce::AudioProcessorValueTreeState::ParameterLayout createParameters();
+    const ScaleTable& scaleTable;
+
+    // Raw values of the parameters, resolved once in the constructor
+    struct ParameterHandles
+    {
+        std::atomic<float>* chordMethod = nullptr;
+        std::atomic<float>* scaleRoot = nullptr;
+        std::atomic<float>* scaleType = nullptr;
+        std::atomic<float>* followMidiIn = nullptr;
+        std::atomic<float>* followMidiInAutomation = nullptr;
+        juce::RangedAudioParameter* scaleRootParameter = nullptr;
+
+        // One per arpeggiator
+        juce::Array<std::atomic<float>*> arpOn;
+        juce::Array<std::atomic<float>*> midiChannel;
+        juce::Array<std::atomic<float>*> subdivision;
+        juce::Array<std::atomic<float>*> gate;
+        juce::Array<std::atomic<float>*> swing;
+        juce::Array<std::atomic<float>*> voicing;
+
+        // In the order of the binary state: the global parameters, then the
+        // parameters of each lane, lane after lane
+        juce::Array<juce::RangedAudioParameter*> globalParameters;
+        juce::Array<juce::RangedAudioParameter*> laneParameters;
+        int numParametersPerLane = 0;
+    };
+    ParameterHandles parameters;
+
+    // What parameterChanged() has to update for each parameter ID
+    enum class ParameterKind
+    {
+        arpOn,
+        midiChannel,
+        subdivision,
+        gate,
+        swing,
+        voicing,
+        chordMethod,
+        scaleRoot,
+        scaleType,
+        followMidiIn,
+        followMidiInAutomation
+    };
+    struct ParameterTarget
+    {
+        ParameterKind kind = ParameterKind::chordMethod;
+        int arpIndex = -1; // -1 for the global parameters
+    };
+    juce::HashMap<juce::String, ParameterTarget> parameterTargets;
+
+    // The state is a binary chunk (see getStateInformation), or the XML
+    // saved by earlier versions of the plugin. Both return false if the data
+    // is not in their format.
+    bool readBinaryState (const void* data, int sizeInBytes);
+    bool readXmlState (const void* data, int sizeInBytes);
+    void restorePattern (int index, const juce::String& pattern);
+
+    // What the lanes have to do in the current block, in order. processBlock
+    // records it once, then each lane plays it into its own buffer, so the
+    // lanes do not depend on each other and can run on any thread.
+    struct LaneCommand
+    {
+        enum class Type
+        {
+            reset,          // The transport stopped
+            render,         // Run the lane from samplePosition to endSample
+            setVelocity,    // A key was pressed
+            setChord        // The held notes changed
+        };
+
+        Type type = Type::render;
+        int samplePosition = 0;
+        int endSample = 0;                              // render
+        juce::uint8 velocity = 0;                       // setVelocity
+        ArpChord chord;                                 // setChord
+        int baseOctaveNote = -1;                        // setChord: note that sets the base octave, or -1
+        bool turnOff = false;                           // setChord: the last key was released
+    };
+    juce::Array<LaneCommand> laneCommands;
+
+    // Records the chord built from the held notes, at a sample position of the current block
+    void addChordCommand (int samplePosition);
+    // Records a run of the lanes between two sample positions of the current block
+    void addRenderCommand (int startSample, int endSample);
+    // Plays the commands of the current block on one lane, into its buffer
+    void renderLane (int index);
+    void runJob (int index) noexcept override;
+
+    // The clock of all the lanes
+    TransportTracker transport;
+
+    std::atomic<juce::int64> randomSeed { 0 };
+    juce::int64 laneRandomSeed = 0;         // The seed the lanes have, on the audio thread
+    std::array<juce::uint32, maxNumArpeggiators> numRandomPatterns {};
+
+    // Lane state, one entry per lane side by side, so the per-block loops walk
+    // contiguous memory. Only the first numArpeggiators entries are used.
+    std::array<ArpEngine, maxNumArpeggiators> arpeggiators;
+    std::array<int, maxNumArpeggiators> arpeggiatorMidiChannels {};
+    std::atomic<juce::uint32> activeLanes { 0 }; // One bit per lane that is on
+
+    void setLaneOn (int index, bool shouldBeOn) noexcept;
+
+    // The lanes that are on, taken once at the start of each block, in order
+    std::array<int, maxNumArpeggiators> blockLanes {};
+    int numBlockLanes = 0;
+
+    // Each lane writes into its own buffer, merged into the host's at the end of the block
+    std::array<juce::MidiBuffer, maxNumArpeggiators> laneBuffers;
+
+    // What the UI shows, published at the end of each block
+    LaneTelemetry telemetry;
+    juce::uint16 chordPitchClasses = 0;
+    int chordRoot = -1;
+    void publishTelemetry();
+
+    // With "Follow MIDI In", the audio thread only keeps the followed root and
+    // queues its changes. The message thread drains the queue from its timer
+    // and, if followMidiInAutomation is on, writes the root to the scaleRoot
+    // parameter, so the host can record it.
+    std::atomic<int> followedRoot { -1 };
+    juce::AbstractFifo followedRootFifo { 64 };
+    std::array<int, 64> followedRootQueue {};
+    std::atomic<bool> followedRootDropped { false };
+    std::atomic<bool> isWritingFollowedRoot { false };
+    void queueFollowedRoot (int root) noexcept;
+    void timerCallback() override;
+
+    bool useWorkerThreads = true;
+    std::unique_ptr<LaneWorkerPool> workerPool;
+    HeldNoteSet heldNotes;
 
-    double lastKnownBPM = 120.0;
-    bool wasPlaying = false;
-    juce::Array<bool> arpeggiatorOnStates;
-    juce::Array<int> arpeggiatorMidiChannels;
-    
-    juce::Array<Arpeggiator> arpeggiators;
-    juce::Array<int> heldNotes;
+    // Note events of the current block, copied out of the host's MidiBuffer
+    struct InputNote
+    {
+        int samplePosition;
+        int noteNumber;
+        juce::uint8 velocity;
+        bool isNoteOn;
+    };
+    juce::Array<InputNote> inputNotes;
+    size_t outputBufferSize = 0;
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TeArAudioProcessor)
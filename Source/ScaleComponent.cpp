@@ -19,6 +19,13 @@ ScaleComponent::~ScaleComponent()
 {
 }
 
+bool ScaleComponent::NoteState::operator== (const NoteState& other) const noexcept
+{
+    return scalePitchClasses == other.scalePitchClasses
+        && rootPitchClass == other.rootPitchClass
+        && lanePitchClasses == other.lanePitchClasses;
+}
+
 void ScaleComponent::paint(juce::Graphics &g)
 {
     // Background
@@ -33,45 +40,68 @@ void ScaleComponent::paint(juce::Graphics &g)
     const float height = (float)getHeight();
     const float noteWidth = width / numNotes;
 
-    static const juce::String noteNames[] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
-
-    const juce::Colour tickColour = juce::Colours::grey;
-    const juce::Colour scaleTickColour = juce::Colours::white;
     const juce::Colour rootHighlightColour = juce::Colours::white;
+    const auto clipBounds = g.getClipBounds();
 
     for (int i = 0; i < numNotes; ++i)
     {
-        const float x = i * noteWidth;
-        // The scaleNotes array can contain values > 11 to represent octave wrapping.
-        // We need to check if any note in the scale corresponds to the current semitone (i).
-        const bool isNoteInScale = std::any_of(scaleNotes.begin(), scaleNotes.end(),
-                                               [i](int note) { return (note % 12) == i; });
+        // Only the columns that changed are repainted, skip the others.
+        if (!clipBounds.intersects(getColumnBounds(i)))
+            continue;
 
-        const bool isRootNote = (i == (rootNote % 12));
+        const float x = i * noteWidth;
 
         // --- Draw Highlights ---
         // Draw root note first, so current notes can be drawn on top if they overlap.
-        if (isRootNote)
+        if (i == state.rootPitchClass)
         {
             g.setColour(rootHighlightColour);
             g.drawRoundedRectangle(x+20.f, 5.0f, noteWidth-40.f, height-10.f,10.0f,2.f);
         }
 
         // Draw highlights for all currently playing notes
-        for (const auto& noteInfo : currentNotes)
+        for (int lane = 0; lane < maxNumLanes; ++lane)
         {
-            if (auto* obj = noteInfo.getDynamicObject())
+            if ((state.lanePitchClasses[(size_t) lane] >> i) & 1)
             {
-                int note = obj->getProperty("note");
-                int arpIndex = obj->getProperty("arpIndex");
-
-                if ((note % 12) == i)
-                {
-                    g.setColour(getColourForArp(arpIndex).withAlpha(0.7f));
-                    g.fillRoundedRectangle(x+20.f, 5.0f, noteWidth - 40.f, height - 10.f, 10.0f);
-                }
+                g.setColour(getColourForArp(lane).withAlpha(0.7f));
+                g.fillRoundedRectangle(x+20.f, 5.0f, noteWidth - 40.f, height - 10.f, 10.0f);
             }
         }
+    }
+
+    // --- Draw Ticks and Note Names ---
+    // They only change with the scale, so they are drawn once into an image.
+    const float scaleFactor = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (!labelsAreValid || labelsPitchClasses != state.scalePitchClasses
+         || labelsImage.getWidth() != juce::jmax(1, juce::roundToInt(width * scaleFactor)))
+        renderLabels(scaleFactor);
+
+    g.drawImage(labelsImage, getLocalBounds().toFloat());
+}
+
+void ScaleComponent::renderLabels(float scaleFactor)
+{
+    const int numNotes = 12;
+    const float width = (float)getWidth();
+    const float height = (float)getHeight();
+    const float noteWidth = width / numNotes;
+
+    labelsImage = juce::Image(juce::Image::ARGB, juce::jmax(1, juce::roundToInt(width * scaleFactor)),
+                              juce::jmax(1, juce::roundToInt(height * scaleFactor)), true);
+    juce::Graphics g(labelsImage);
+    g.addTransform(juce::AffineTransform::scale(scaleFactor));
+
+    static const juce::String noteNames[] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+
+    const juce::Colour tickColour = juce::Colours::grey;
+    const juce::Colour scaleTickColour = juce::Colours::white;
+
+    for (int i = 0; i < numNotes; ++i)
+    {
+        const float x = i * noteWidth;
+        const bool isNoteInScale = (state.scalePitchClasses >> i) & 1;
+
         // --- Draw Ticks ---
         float tickHeight = height * 0.3f;
         float tickThickness = 1.0f;
@@ -96,23 +126,70 @@ void ScaleComponent::paint(juce::Graphics &g)
         g.setFont(15.0f);
         g.drawText(noteNames[i], x, height - 30.0f, noteWidth, 12.0f, juce::Justification::centred);
     }
+
+    labelsPitchClasses = state.scalePitchClasses;
+    labelsAreValid = true;
+}
+
+void ScaleComponent::resized()
+{
+    labelsAreValid = false;
+}
+
+void ScaleComponent::setNoteState(const NoteState& newState)
+{
+    const auto changedColumns = getChangedColumns(state, newState);
+    if (changedColumns == 0)
+        return;
+
+    state = newState;
+    for (int i = 0; i < 12; ++i)
+        if ((changedColumns >> i) & 1)
+            repaint(getColumnBounds(i));
+}
+
+juce::uint16 ScaleComponent::getChangedColumns(const NoteState& a, const NoteState& b) noexcept
+{
+    auto changed = (juce::uint16) (a.scalePitchClasses ^ b.scalePitchClasses);
+
+    if (a.rootPitchClass != b.rootPitchClass)
+    {
+        if (juce::isPositiveAndBelow(a.rootPitchClass, 12)) changed |= (juce::uint16) (1 << a.rootPitchClass);
+        if (juce::isPositiveAndBelow(b.rootPitchClass, 12)) changed |= (juce::uint16) (1 << b.rootPitchClass);
+    }
+
+    for (size_t lane = 0; lane < a.lanePitchClasses.size(); ++lane)
+        changed |= (juce::uint16) (a.lanePitchClasses[lane] ^ b.lanePitchClasses[lane]);
+
+    return changed;
 }
 
-void ScaleComponent::updateScale(const juce::Array<int> &newScaleNotes, int newRootNote, const juce::Array<juce::var>& newCurrentNotes)
+juce::Rectangle<int> ScaleComponent::getColumnBounds(int pitchClass) const
 {
-  scaleNotes = newScaleNotes;
-  rootNote = newRootNote;
-  currentNotes = newCurrentNotes;
-  repaint();
+    const float noteWidth = (float)getWidth() / 12.0f;
+    return juce::Rectangle<float>(pitchClass * noteWidth, 0.0f, noteWidth, (float)getHeight()).getSmallestIntegerContainer();
 }
 
-juce::Colour ScaleComponent::getColourForArp(int arpIndex) const
+juce::Colour ScaleComponent::getColourForArp(int arpIndex)
 {
+    // The first four are the original lanes, the others sit between them on the colour wheel.
     static const juce::Colour arpColours[] = {
         juce::Colours::lime,
         juce::Colours::cyan,
         juce::Colours::magenta,
-        juce::Colours::yellow
+        juce::Colours::yellow,
+        juce::Colours::orange,
+        juce::Colours::deepskyblue,
+        juce::Colours::hotpink,
+        juce::Colours::greenyellow,
+        juce::Colours::coral,
+        juce::Colours::aquamarine,
+        juce::Colours::violet,
+        juce::Colours::gold,
+        juce::Colours::tomato,
+        juce::Colours::turquoise,
+        juce::Colours::orchid,
+        juce::Colours::khaki
     };
-    return juce::isPositiveAndBelow(arpIndex, 4) ? arpColours[arpIndex] : juce::Colours::green;
+    return juce::isPositiveAndBelow(arpIndex, (int) std::size(arpColours)) ? arpColours[arpIndex] : juce::Colours::green;
 }
@@ -16,18 +16,42 @@
 class ScaleComponent : public juce::Component
 {
 public:
+    static constexpr int maxNumLanes = 16;
+
+    // What the component shows, one bit per pitch class (bit 0 is C)
+    struct NoteState
+    {
+        juce::uint16 scalePitchClasses = 0;                         // Notes of the scale or chord
+        int rootPitchClass = -1;                                    // Outlined note, or -1
+        std::array<juce::uint16, maxNumLanes> lanePitchClasses {};  // Notes being played, per lane
+
+        bool operator== (const NoteState& other) const noexcept;
+        bool operator!= (const NoteState& other) const noexcept { return !operator==(other); }
+    };
+
     ScaleComponent();
 
     ~ScaleComponent() override;
 
     void paint(juce::Graphics& g) override;
+    void resized() override;
 
-    void updateScale(const juce::Array<int> &newScaleNotes, int newRootNote, const juce::Array<juce::var>& newCurrentNotes);
+    // Only repaints the note columns that changed, if any
+    void setNoteState(const NoteState& newState);
+
+    // The colour of each arpeggiator lane, shared with the editor
+    static juce::Colour getColourForArp(int arpIndex);
     
 private:
-    juce::Array<int> scaleNotes;
-    int rootNote = -1;
-    juce::Array<juce::var> currentNotes; // Array of objects: { note: 60, arpIndex: 0 }
+    // Bits of the note columns that look different between two states
+    static juce::uint16 getChangedColumns(const NoteState& a, const NoteState& b) noexcept;
+    juce::Rectangle<int> getColumnBounds(int pitchClass) const;
+    // Draws the ticks and note names, which only change with the scale, into labelsImage
+    void renderLabels(float scaleFactor);
+
+    NoteState state;
 
-    juce::Colour getColourForArp(int arpIndex) const;
+    juce::Image labelsImage;
+    juce::uint16 labelsPitchClasses = 0;
+    bool labelsAreValid = false;
 };
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    ScaleTable.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#include "ScaleTable.h"
+
+const ScaleTable& ScaleTable::getInstance()
+{
+    static const ScaleTable table;
+    return table;
+}
+
+ScaleTable::ScaleTable()
+{
+    numScaleTypes = MidiTools::Scale::getScaleTypeNames().size();
+
+    const auto numScales = (size_t) (12 * numScaleTypes);
+    degrees.resize (numScales * 12, 0);
+    chords.reserve (numScales * 12);
+
+    for (int root = 0; root < 12; ++root)
+    {
+        for (int type = 0; type < numScaleTypes; ++type)
+        {
+            const MidiTools::Scale scale (root, static_cast<MidiTools::Scale::Type> (type));
+            const auto& scaleNotes = scale.getNotes();
+            const auto scaleIndex = (size_t) getScaleIndex (root, type);
+
+            for (int pitchClass = 0; pitchClass < 12; ++pitchClass)
+            {
+                // A note that is not in the scale takes the degree of the nearest note below it.
+                int degree = -1;
+                for (int i = 0; i < 12 && degree == -1; ++i)
+                    degree = scaleNotes.indexOf ((pitchClass - i + 12) % 12);
+
+                degrees[scaleIndex * 12 + (size_t) pitchClass] = (juce::int8) juce::jmax (0, degree);
+            }
+
+            // Unused degrees of scales with fewer than 12 notes get an empty chord.
+            for (int degree = 0; degree < 12; ++degree)
+                chords.push_back (degree < scaleNotes.size() ? ArpChord::fromDegrees (MidiTools::Chord::fromScaleAndDegree (scale, degree))
+                                                             : ArpChord());
+        }
+    }
+}
+
+int ScaleTable::getScaleIndex (int root, int scaleType) const noexcept
+{
+    return ((root % 12 + 12) % 12) * numScaleTypes + juce::jlimit (0, numScaleTypes - 1, scaleType);
+}
+
+int ScaleTable::getDegree (int root, int scaleType, int pitchClass) const noexcept
+{
+    return degrees[(size_t) getScaleIndex (root, scaleType) * 12 + (size_t) ((pitchClass % 12 + 12) % 12)];
+}
+
+const ArpChord& ScaleTable::getChord (int root, int scaleType, int pitchClass) const noexcept
+{
+    return chords[(size_t) getScaleIndex (root, scaleType) * 12 + (size_t) getDegree (root, scaleType, pitchClass)];
+}
@@ -0,0 +1,53 @@
+/*
+  ==============================================================================
+
+    ScaleTable.h
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "libs/cppMusicTools/MidiTools.h"
+#include "ArpChord.h"
+
+//==============================================================================
+/**
+    The chords of the "Single note" chord method for every root, scale type
+    and pitch class.
+
+    For each of the 12 roots and each scale type, every pitch class maps to its
+    degree in the scale, or to the nearest degree below it if it is not in the
+    scale, and to the chord built on that degree. The table is built once, the
+    first time it is used, so the audio thread only indexes into it.
+*/
+class ScaleTable
+{
+public:
+    /** The table shared by all the plugin instances. Call it once from the
+        message thread before the audio thread uses it. */
+    static const ScaleTable& getInstance();
+
+    int getNumScaleTypes() const noexcept                       { return numScaleTypes; }
+
+    /** The degree of a pitch class in a scale, snapped down to the nearest
+        degree of the scale. */
+    int getDegree (int root, int scaleType, int pitchClass) const noexcept;
+
+    /** The chord built on the degree of a pitch class in a scale. */
+    const ArpChord& getChord (int root, int scaleType, int pitchClass) const noexcept;
+
+private:
+    ScaleTable();
+
+    int getScaleIndex (int root, int scaleType) const noexcept;
+
+    int numScaleTypes = 0;
+    std::vector<juce::int8> degrees;        // [root][scaleType][pitchClass]
+    std::vector<ArpChord> chords;           // [root][scaleType][degree], 12 degrees per scale
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ScaleTable)
+};
@@ -0,0 +1,195 @@
+/*
+  ==============================================================================
+
+    TransportTracker.cpp
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#include "TransportTracker.h"
+
+//==============================================================================
+TransportTracker::Position TransportTracker::Position::fromQuarterNotes (double quarterNotes) noexcept
+{
+    const auto ticks = quarterNotes * ticksPerQuarterNote;
+    const auto wholeTicks = std::floor (ticks);
+    return { (juce::int64) wholeTicks, ticks - wholeTicks };
+}
+
+TransportTracker::Position TransportTracker::Position::movedBy (double numTicks) const noexcept
+{
+    // Only the part below a tick is a double, so the clock keeps its precision
+    // however long it runs.
+    const auto ticks = fraction + numTicks;
+    const auto wholeTicks = std::floor (ticks);
+    return { tick + (juce::int64) wholeTicks, ticks - wholeTicks };
+}
+
+TransportTracker::Position TransportTracker::Segment::getPositionAt (double sample) const noexcept
+{
+    const auto elapsed = sample - (double) startSample;
+    return start.movedBy (elapsed * (speed + 0.5 * acceleration * elapsed));
+}
+
+double TransportTracker::Segment::getSampleAt (juce::int64 tick) const noexcept
+{
+    static constexpr double never = 1.0e12;
+
+    // Solves distance = speed * s + acceleration * s^2 / 2, in a form that
+    // stays exact when the acceleration is zero.
+    const auto distance = (double) (tick - start.tick) - start.fraction;
+    const auto discriminant = speed * speed + 2.0 * acceleration * distance;
+
+    // Speeding up, the clock only went back to a certain tick before the
+    // start: anything behind it comes before every sample.
+    if (discriminant < 0.0 && distance < 0.0)
+        return -std::numeric_limits<double>::infinity();
+
+    if (speed <= 0.0 || discriminant < 0.0)
+        return never;
+
+    const auto elapsed = 2.0 * distance / (speed + std::sqrt (discriminant));
+
+    // A tick that rounding puts a hair past a sample still lands on it.
+    return (double) startSample + std::ceil (elapsed - 1.0e-6);
+}
+
+//==============================================================================
+void TransportTracker::prepare (double newSampleRate) noexcept
+{
+    sampleRate = newSampleRate;
+    playing = wasPlaying = tempoWasChanging = false;
+    lastNumSamples = 0;
+    blockStartSample = nextBlockStartSample = 0;
+    numSegments = 0;
+    ++clockRun;
+}
+
+void TransportTracker::update (juce::AudioPlayHead* playHead, int numSamples) noexcept
+{
+    wasPlaying = playing;
+    blockStartSample = nextBlockStartSample;
+    nextBlockStartSample += juce::jmax (0, numSamples);
+
+    // Without a position from the host, the clock goes on from where it was.
+    auto startPosition = expectedPosition;
+    bool looping = false;
+    juce::AudioPlayHead::LoopPoints loopPoints;
+
+    if (playHead != nullptr)
+    {
+        if (const auto position = playHead->getPosition())
+        {
+            playing = position->getIsPlaying();
+
+            if (const auto hostBpm = position->getBpm(); hostBpm.hasValue() && *hostBpm > 0.0)
+                bpm = *hostBpm;
+
+            if (const auto ppq = position->getPpqPosition(); ppq.hasValue() && playing)
+                startPosition = Position::fromQuarterNotes (*ppq);
+
+            if (const auto points = position->getLoopPoints())
+            {
+                looping = position->getIsLooping() && points->ppqEnd > points->ppqStart;
+                loopPoints = *points;
+            }
+        }
+    }
+
+    const auto speed = bpm * ticksPerQuarterNote / (60.0 * sampleRate);
+    const bool continues = playing && wasPlaying;
+    const bool jumped = continues && std::abs (startPosition.getTicksSince (expectedPosition)) > jumpTolerance;
+
+    if (jumped || (playing && ! wasPlaying))
+        ++clockRun;
+
+    // The host gives the tempo at the start of each block only. If it changed
+    // at the start of the last two blocks, it is ramping, and goes on at the
+    // same rate. A single change is a step, which the block plays as is.
+    const bool tempoChanged = continues && speed != lastSpeed;
+    auto acceleration = 0.0;
+    if (tempoChanged && tempoWasChanging && ! jumped && lastNumSamples > 0)
+    {
+        acceleration = (speed - lastSpeed) / lastNumSamples;
+        if (speed + acceleration * numSamples <= 0.0)
+            acceleration = 0.0;
+    }
+
+    tempoWasChanging = tempoChanged;
+    lastSpeed = speed;
+    lastNumSamples = numSamples;
+    numSegments = 0;
+
+    if (numSamples <= 0)
+        return;
+
+    Segment segment { 0, numSamples, startPosition, speed, acceleration, clockRun };
+
+    // Each time the position reaches the end of the loop, the rest of the
+    // block starts again from the start of the loop.
+    const auto loopStart = Position::fromQuarterNotes (loopPoints.ppqStart);
+    const auto loopEnd = Position::fromQuarterNotes (loopPoints.ppqEnd);
+
+    if (playing && looping && startPosition.getTicksSince (loopEnd) < 0.0)
+    {
+        while (numSegments < maxNumSegments - 1)
+        {
+            // The loop end is reached on the sample at or after it.
+            const auto wrapSample = segment.getSampleAt (loopEnd.fraction > 0.0 ? loopEnd.tick + 1 : loopEnd.tick);
+            if (wrapSample >= (double) numSamples)
+                break;
+
+            segment.endSample = (int) wrapSample;
+            addSegment (segment);
+
+            const auto elapsed = wrapSample - (double) segment.startSample;
+            segment = { (int) wrapSample, numSamples, loopStart, segment.speed + segment.acceleration * elapsed, acceleration, ++clockRun };
+        }
+    }
+
+    addSegment (segment);
+}
+
+void TransportTracker::restartAt (int samplePosition) noexcept
+{
+    if (playing || numSegments == 0)
+        return;
+
+    // With no room left, the previous restart is dropped: the segment before
+    // it runs on to the end of the block, and this restart takes its place.
+    if (numSegments == maxNumSegments)
+    {
+        segments[(size_t) numSegments - 2].endSample = segments[(size_t) numSegments - 1].endSample;
+        --numSegments;
+    }
+
+    auto segment = segments[(size_t) numSegments - 1];
+    const auto elapsed = (double) (samplePosition - segment.startSample);
+
+    // The part of the block before the restart keeps the old position.
+    --numSegments;
+    if (samplePosition > segment.startSample)
+        addSegment ({ segment.startSample, samplePosition, segment.start, segment.speed, segment.acceleration, segment.run });
+
+    addSegment ({ samplePosition, segment.endSample, {}, segment.speed + segment.acceleration * elapsed, segment.acceleration, ++clockRun });
+}
+
+double TransportTracker::getTicksPerSampleAt (int samplePosition) const noexcept
+{
+    for (int i = 0; i < numSegments; ++i)
+    {
+        const auto& segment = segments[(size_t) i];
+        if (samplePosition < segment.endSample || i == numSegments - 1)
+            return segment.speed + segment.acceleration * (samplePosition - segment.startSample);
+    }
+
+    return bpm * ticksPerQuarterNote / (60.0 * sampleRate);
+}
+
+void TransportTracker::addSegment (const Segment& segment) noexcept
+{
+    segments[(size_t) numSegments++] = segment;
+    expectedPosition = segment.getPositionAt ((double) segment.endSample);
+}
@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    TransportTracker.h
+    Created: 18 Oct 2026
+    Author:  doare
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    The clock all the lanes play from, and where its ticks fall in each block.
+
+    The clock counts whole ticks, ticksPerQuarterNote to a quarter note, which
+    every subdivision divides exactly. The lanes take their steps on the ticks
+    that are multiples of their step length, so they share one phase, whatever
+    their subdivisions and for as long as they play.
+
+    While the host plays, the clock follows its position. The host only gives
+    it at the start of each block: the tracker splits the block where the
+    position cannot move on continuously, at the end of the host's loop, and
+    follows a tempo ramp by carrying the change of tempo between the last
+    blocks over to this one. Each block starts again from the host's position,
+    so rounding never adds up. While the host is stopped, the clock runs on at
+    the last tempo.
+*/
+class TransportTracker
+{
+public:
+    static constexpr int ticksPerQuarterNote = 960;
+    static constexpr int maxNumSegments = 8;
+
+    /** A position of the clock: a whole tick, and how far it is to the next. */
+    struct Position
+    {
+        juce::int64 tick = 0;
+        double fraction = 0.0;  // From 0 to 1
+
+        static Position fromQuarterNotes (double quarterNotes) noexcept;
+
+        Position movedBy (double numTicks) const noexcept;
+        double getTicksSince (Position other) const noexcept { return (double) (tick - other.tick) + (fraction - other.fraction); }
+    };
+
+    /** A part of the block over which the clock moves on continuously. */
+    struct Segment
+    {
+        int startSample = 0;
+        int endSample = 0;
+        Position start;
+        double speed = 0.0;             // Ticks per sample, at startSample
+        double acceleration = 0.0;      // Change of speed per sample
+        juce::uint32 run = 0;           // Changes where the clock was set anew (see LastStep)
+
+        Position getPositionAt (double sample) const noexcept;
+
+        /** The first sample at or after the tick, which may be outside the
+            segment. A tick behind the start that the segment does not reach
+            going backwards gives minus infinity, and a tick ahead that it
+            never reaches gives a huge value. */
+        double getSampleAt (juce::int64 tick) const noexcept;
+    };
+
+    /** Where a lane's last step fell on the clock.
+
+        The position of a block is partly guessed, for a tempo ramp, and the
+        next block starts again from the host's, which may differ by a few
+        ticks. forEachStep() keeps this per lane, so that a step is not played
+        again, or missed, when the two disagree around the end of a block.
+        It starts over wherever the clock is set anew: when the host starts,
+        jumps or loops, and at a restart.
+    */
+    struct LastStep
+    {
+        juce::uint32 run = 0;
+        juce::int64 tick = 0;
+    };
+
+    TransportTracker() = default;
+
+    void prepare (double newSampleRate) noexcept;
+
+    /** Reads the position of the host at the start of a block. */
+    void update (juce::AudioPlayHead* playHead, int numSamples) noexcept;
+
+    /** While the host is stopped: starts the clock again from tick 0 at a
+        sample of the current block, so the lanes start together on it. */
+    void restartAt (int samplePosition) noexcept;
+
+    bool isPlaying() const noexcept                     { return playing; }
+    bool hasStopped() const noexcept                    { return wasPlaying && ! playing; }
+
+    /** The number of samples processed before this block since prepare(),
+        the absolute time of the note-offs the lanes schedule. */
+    juce::int64 getBlockStartSample() const noexcept    { return blockStartSample; }
+
+    /** The tick on which a step starts, for steps of ticksPerStep ticks of
+        which the odd ones are delayed by swingTicks. */
+    static juce::int64 getStepTick (juce::int64 step, juce::int64 ticksPerStep, juce::int64 swingTicks) noexcept
+    {
+        return step * ticksPerStep + ((step & 1) != 0 ? swingTicks : 0);
+    }
+
+    /** The speed of the clock, in ticks per sample, at a sample of the block. */
+    double getTicksPerSampleAt (int samplePosition) const noexcept;
+
+    /** Calls step (samplePosition, stepIndex) for each step that starts
+        between startSample (included) and endSample (excluded), in order.
+        The steps are ticksPerStep ticks long, counted from tick 0, and the
+        odd ones are delayed by swingTicks, which is less than a step.
+
+        A step lands on the same sample however the block is split, so
+        consecutive calls never play a step twice or miss one. Across blocks,
+        lastStep does the same where the host's position disagrees with the
+        one the tracker guessed.
+    */
+    template <typename Callback>
+    void forEachStep (juce::int64 ticksPerStep, juce::int64 swingTicks, int startSample, int endSample,
+                      LastStep& lastStep, Callback&& step) const
+    {
+        if (ticksPerStep <= 0)
+            return;
+
+        for (int i = 0; i < numSegments; ++i)
+        {
+            const auto& segment = segments[(size_t) i];
+            const auto from = juce::jmax (startSample, segment.startSample);
+            const auto to = juce::jmin (endSample, segment.endSample);
+
+            if (from >= to)
+                continue;
+
+            auto getStepSample = [&] (juce::int64 index) { return segment.getSampleAt (getStepTick (index, ticksPerStep, swingTicks)); };
+
+            // Start from a step that is before the first sample, then move
+            // onto the first step at or after it. The step before the one of
+            // the tick at the previous sample always is, swing or not.
+            const auto tickBefore = segment.getPositionAt ((double) from - 1.0).tick;
+            auto index = (tickBefore >= 0 ? tickBefore / ticksPerStep : -((ticksPerStep - 1 - tickBefore) / ticksPerStep)) - 1;
+            while (getStepSample (index) < (double) from)
+                ++index;
+
+            if (segment.run == lastStep.run)
+            {
+                // The host's position came out a little behind the guess:
+                // the steps that were played already are not played again.
+                while (getStepTick (index, ticksPerStep, swingTicks) <= lastStep.tick)
+                    ++index;
+
+                // Or a little ahead of it: the step it went past is played
+                // late, on the first sample of the block, rather than never.
+                const auto missedTick = getStepTick (index - 1, ticksPerStep, swingTicks);
+                if (from == 0 && missedTick > lastStep.tick
+                     && missedTick >= segment.start.tick - (juce::int64) jumpTolerance)
+                {
+                    lastStep = { segment.run, missedTick };
+                    step (from, index - 1);
+                }
+            }
+
+            for (auto sample = getStepSample (index); sample < (double) to; sample = getStepSample (++index))
+            {
+                lastStep = { segment.run, getStepTick (index, ticksPerStep, swingTicks) };
+                step ((int) sample, index);
+            }
+        }
+    }
+
+private:
+    // A block that starts this many ticks away from where the last one ended
+    // was moved by the host.
+    static constexpr double jumpTolerance = 10.0;
+
+    void addSegment (const Segment& segment) noexcept;
+
+    double sampleRate = 44100.0;
+    double bpm = 120.0;
+
+    bool playing = false;
+    bool wasPlaying = false;
+
+    // Where the block ends, and the speed and length of the last one, to see
+    // where the next one should start and how the tempo is changing.
+    Position expectedPosition;
+    double lastSpeed = 0.0;
+    int lastNumSamples = 0;
+    bool tempoWasChanging = false;
+
+    juce::int64 blockStartSample = 0;
+    juce::int64 nextBlockStartSample = 0;
+
+    // Counts the times the clock was set anew, to tell the lanes (see LastStep)
+    juce::uint32 clockRun = 0;
+
+    std::array<Segment, maxNumSegments> segments {};
+    int numSegments = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TransportTracker)
+};
@@ -11,10 +11,12 @@
 #include "popupWindow.h"
 
 ArpPatternPopup::ArpPatternPopup(std::function<juce::String(int, int, int)> makeEuclidian,
+                                 std::function<juce::Array<juce::uint64>(int, int)> getEuclidianRotations,
                                  std::function<juce::String()> makeRandom,
                                  std::function<void(juce::String)> onOk,
                                  juce::Colour color)
     : makeEuclidianCallback(makeEuclidian),
+      getEuclidianRotationsCallback(getEuclidianRotations),
       makeRandomCallback(makeRandom),
       onOkCallback(onOk),
       mainColor(color)
@@ -36,6 +38,7 @@ ArpPatternPopup::ArpPatternPopup(std::function<juce::String(int, int, int)> make
     hitsEditor.setInputRestrictions(2, "0123456789");
     hitsEditor.setColour(juce::TextEditor::backgroundColourId, juce::Colours::darkblue.darker(2.f));
     hitsEditor.setColour(juce::TextEditor::textColourId, mainColor);
+    hitsEditor.onTextChange = [this] { updatePreviews(); };
 
     addAndMakeVisible(stepsLabel);
     stepsLabel.setText("Steps:", juce::dontSendNotification);
@@ -47,6 +50,7 @@ ArpPatternPopup::ArpPatternPopup(std::function<juce::String(int, int, int)> make
     stepsEditor.setInputRestrictions(2, "0123456789");
     stepsEditor.setColour(juce::TextEditor::backgroundColourId, juce::Colours::darkblue.darker(2.f));
     stepsEditor.setColour(juce::TextEditor::textColourId, mainColor);
+    stepsEditor.onTextChange = [this] { updatePreviews(); };
 
     addAndMakeVisible(rotateLabel);
     rotateLabel.setText("Rot:", juce::dontSendNotification);
@@ -58,6 +62,7 @@ ArpPatternPopup::ArpPatternPopup(std::function<juce::String(int, int, int)> make
     rotateEditor.setInputRestrictions(3, "-0123456789");
     rotateEditor.setColour(juce::TextEditor::backgroundColourId, juce::Colours::darkblue.darker(2.f));
     rotateEditor.setColour(juce::TextEditor::textColourId, mainColor);
+    rotateEditor.onTextChange = [this] { repaint(previewArea); };
 
     addAndMakeVisible(randomizeBtn);
     randomizeBtn.setColour(juce::TextButton::buttonColourId, juce::Colours::transparentBlack);
@@ -103,7 +108,8 @@ ArpPatternPopup::ArpPatternPopup(std::function<juce::String(int, int, int)> make
             box->dismiss();
     };
 
-    setSize(360, 200);
+    updatePreviews();
+    setSize(360, 300);
 }
 
 ArpPatternPopup::~ArpPatternPopup()
@@ -115,6 +121,59 @@ void ArpPatternPopup::paint(juce::Graphics& g)
     g.fillAll(juce::Colours::darkblue.darker(2.f)); // Background for the popup content
     g.setColour(mainColor);
     g.drawRect(getLocalBounds(), 1);
+
+    if (rotationPreviews.isEmpty() || previewArea.isEmpty())
+        return;
+
+    // One row per rotation, one cell per step, the hits filled
+    const float cellWidth = (float) previewArea.getWidth() / (float) previewSteps;
+    const float rowHeight = (float) previewArea.getHeight() / (float) rotationPreviews.size();
+    const int selectedRotation = rotateEditor.getText().getIntValue();
+
+    for (int rotation = 0; rotation < rotationPreviews.size(); ++rotation)
+    {
+        const auto mask = rotationPreviews.getUnchecked(rotation);
+        const float y = (float) previewArea.getY() + (float) rotation * rowHeight;
+        const bool isSelected = ((selectedRotation % previewSteps) + previewSteps) % previewSteps == rotation;
+
+        g.setColour(isSelected ? mainColor : mainColor.withAlpha(0.5f));
+        for (int step = 0; step < previewSteps; ++step)
+            if (((mask >> step) & 1) != 0)
+                g.fillRect(juce::Rectangle<float>((float) previewArea.getX() + (float) step * cellWidth, y,
+                                                  cellWidth, rowHeight).reduced(juce::jmin(1.f, cellWidth * 0.1f), juce::jmin(1.f, rowHeight * 0.1f)));
+    }
+}
+
+void ArpPatternPopup::updatePreviews()
+{
+    rotationPreviews.clearQuick();
+    previewSteps = juce::jlimit(1, 64, stepsEditor.getText().getIntValue());
+
+    if (getEuclidianRotationsCallback)
+        rotationPreviews = getEuclidianRotationsCallback(hitsEditor.getText().getIntValue(), previewSteps);
+
+    repaint(previewArea);
+}
+
+int ArpPatternPopup::getRotationAt(juce::Point<int> position) const
+{
+    if (rotationPreviews.isEmpty() || !previewArea.contains(position))
+        return -1;
+
+    return juce::jlimit(0, rotationPreviews.size() - 1,
+                        (position.y - previewArea.getY()) * rotationPreviews.size() / juce::jmax(1, previewArea.getHeight()));
+}
+
+void ArpPatternPopup::mouseDown(const juce::MouseEvent& event)
+{
+    const int rotation = getRotationAt(event.getPosition());
+    if (rotation < 0)
+        return;
+
+    // Picking a rotation makes its pattern, as the Euclidean button would.
+    rotateEditor.setText(juce::String(rotation));
+    euclidBtn.triggerClick();
+    repaint(previewArea);
 }
 
 void ArpPatternPopup::resized()
@@ -145,6 +204,10 @@ void ArpPatternPopup::resized()
     euclidRow.removeFromLeft(10);
     euclidBtn.setBounds(euclidRow);
 
+    // Below: the rotations of the rhythm
+    area.removeFromTop(10);
+    previewArea = area.removeFromTop(area.getHeight() - 40);
+
     // Bottom: OK / Cancel
     auto buttonRow = area.removeFromBottom(30);
     okBtn.setBounds(buttonRow.removeFromLeft(buttonRow.getWidth() / 2).reduced(2, 0));
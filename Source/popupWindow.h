@@ -16,6 +16,7 @@ class ArpPatternPopup : public juce::Component
 {
 public:
     ArpPatternPopup(std::function<juce::String(int, int, int)> makeEuclidian,
+                    std::function<juce::Array<juce::uint64>(int, int)> getEuclidianRotations,
                     std::function<juce::String()> makeRandom,
                     std::function<void(juce::String)> onOk,
                     juce::Colour color);
@@ -23,8 +24,14 @@ public:
 
     void paint (juce::Graphics&) override;
     void resized() override;
+    void mouseDown(const juce::MouseEvent& event) override;
 
 private:
+    // Shows every rotation of the rhythm set by the hits and steps, one per
+    // row, so that one can be picked with a click.
+    void updatePreviews();
+    int getRotationAt(juce::Point<int> position) const;
+
     juce::Label patternDisplay;
     juce::Label hitsLabel, stepsLabel, rotateLabel;
     juce::TextEditor hitsEditor, stepsEditor, rotateEditor;
@@ -34,9 +41,14 @@ private:
     juce::TextButton cancelBtn{ "Cancel" };
 
     std::function<juce::String(int, int, int)> makeEuclidianCallback;
+    std::function<juce::Array<juce::uint64>(int, int)> getEuclidianRotationsCallback;
     std::function<juce::String()> makeRandomCallback;
     std::function<void(juce::String)> onOkCallback;
     juce::Colour mainColor;
 
+    juce::Rectangle<int> previewArea;
+    juce::Array<juce::uint64> rotationPreviews;
+    int previewSteps = 0;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ArpPatternPopup)
 };
\ No newline at end of file